@@ -0,0 +1,107 @@
+#include "ga/Fitness.hpp"
+#include "ga/Population.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Best training fitness reached against fitness evaluations spent, for the
+// fixed operator settings the optimizer uses (crossover 0.8, mutation 0.2,
+// uniform redraws) and for 1/5-success-rule adaptive variation from the same
+// starting rates. Each is averaged over --runs seeds; both see the same seeds.
+//
+// Usage: adaptive_bench <adsb_csv_file> [--population N] [--evaluations N] [--runs N]
+//                       [--step S]
+int main(int argc, char* argv[]) {
+  std::string file;
+  size_t      populationSize = 60;
+  size_t      budget = 3000;
+  size_t      runs = 5;
+  double      step = ga::AdaptiveVariation().step;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--population" && i + 1 < argc)
+      populationSize = std::stoul(argv[++i]);
+    else if (arg == "--evaluations" && i + 1 < argc)
+      budget = std::stoul(argv[++i]);
+    else if (arg == "--runs" && i + 1 < argc)
+      runs = std::stoul(argv[++i]);
+    else if (arg == "--step" && i + 1 < argc)
+      step = std::stod(argv[++i]);
+    else
+      file = arg;
+  }
+  if (file.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " <adsb_csv_file> [--population N] [--evaluations N] [--runs N] [--step S]\n";
+    return 1;
+  }
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  auto                       data = preprocessor.loadDataset(file, "results/cache");
+  auto [trainSet, valSet] = dataset::DatasetView(data).split(0.8);
+  ga::Fitness fitness(trainSet);
+
+  // Best fitness after each generation, with the evaluations spent so far.
+  using Curve = std::vector<std::pair<size_t, double>>;
+  auto evolve = [&](bool adaptive, uint64_t seed, size_t& generations) {
+    ga::Population        population(populationSize, fitness, 0.8, 0.2, 3);
+    ga::AdaptiveVariation variation;
+    variation.enabled = adaptive;
+    variation.step = step;
+    population.setAdaptiveVariation(variation);
+    population.setRng(ga::Rng(seed));
+    population.initialize();
+
+    Curve curve;
+    for (generations = 0;; ++generations) {
+      double best = population.fitness(0);
+      for (size_t i = 1; i < population.size(); ++i)
+        best = std::max(best, population.fitness(i));
+      const size_t evaluated = population.evaluationStats().evaluated;
+      curve.push_back({evaluated, best});
+      if (evaluated >= budget || generations >= 100 * budget / populationSize)
+        return curve;
+      population.evolve();
+    }
+  };
+
+  // Best fitness within `evaluations`: survivors are the fittest of parents
+  // and offspring, so the best never falls.
+  auto bestWithin = [](const Curve& curve, size_t evaluations) {
+    double best = 0.0;
+    for (const auto& [spent, fitness] : curve)
+      if (spent <= evaluations)
+        best = fitness;
+    return best;
+  };
+
+  const size_t                     STEPS = 10;
+  std::vector<std::vector<double>> mean(2, std::vector<double>(STEPS, 0.0));
+  std::vector<double>              generationsRun(2, 0.0);
+  for (int adaptive = 0; adaptive < 2; ++adaptive) {
+    for (size_t r = 0; r < runs; ++r) {
+      size_t generations = 0;
+      Curve  curve = evolve(adaptive != 0, r + 1, generations);
+      for (size_t s = 0; s < STEPS; ++s)
+        mean[adaptive][s] += bestWithin(curve, budget * (s + 1) / STEPS) / runs;
+      generationsRun[adaptive] += static_cast<double>(generations) / runs;
+    }
+  }
+
+  std::cout << "\n=== " << file << " (" << trainSet.size() << " train samples, population "
+            << populationSize << ", " << runs << " runs) ===\n\n";
+  std::cout << std::setw(12) << "Evaluations" << std::setw(12) << "fixed" << std::setw(12)
+            << "adaptive" << "\n";
+  for (size_t s = 0; s < STEPS; ++s) {
+    std::cout << std::setw(12) << budget * (s + 1) / STEPS << std::fixed << std::setprecision(5)
+              << std::setw(12) << mean[0][s] << std::setw(12) << mean[1][s] << "\n";
+  }
+  std::cout << std::setprecision(1) << "\nGenerations: fixed " << generationsRun[0]
+            << ", adaptive " << generationsRun[1] << "\n";
+  return 0;
+}
@@ -0,0 +1,21 @@
+# Fails unless the object files A and B disassemble to the same instructions.
+# Usage: cmake -DOBJDUMP=<objdump> -DA=<object> -DB=<object> -P compare_codegen.cmake
+
+foreach(side A B)
+  execute_process(
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${${side}}
+    OUTPUT_VARIABLE disassembly_${side}
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "objdump failed on ${${side}}")
+  endif()
+  # Drop the header line naming the file.
+  string(REGEX REPLACE "[^\n]*file format[^\n]*\n" "" disassembly_${side} "${disassembly_${side}}")
+endforeach()
+
+if(NOT disassembly_A STREQUAL disassembly_B)
+  file(WRITE ${A}.dis "${disassembly_A}")
+  file(WRITE ${B}.dis "${disassembly_B}")
+  message(FATAL_ERROR "Machine code differs; compare ${A}.dis and ${B}.dis")
+endif()
+message(STATUS "Identical machine code: ${A} and ${B}")
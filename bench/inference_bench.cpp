@@ -0,0 +1,85 @@
+#include "fuzzy/AdsbFuzzySystem.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Inference cost of the dynamic FuzzyInferenceSystem over a preprocessed dataset
+// with the default membership parameters: per-sample evaluate() and the batch
+// API on every instruction set the CPU supports, for both defuzzifiers.
+//
+// Usage: inference_bench <adsb_csv_file> [repetitions]
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <adsb_csv_file> [repetitions]\n";
+    return 1;
+  }
+  int repetitions = (argc > 2) ? std::stoi(argv[2]) : 20;
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  auto                       data = preprocessor.loadDataset(argv[1], "results/cache");
+  dataset::DatasetView       samples(data);
+
+  auto                fis = fuzzy::createAdsbFuzzySystem();
+  std::vector<size_t> columns;
+  for (const auto& name : fis.inputNames())
+    columns.push_back(data->featureIndex(name));
+
+  std::vector<const double*> columnPtrs;
+  for (size_t c : columns)
+    columnPtrs.push_back(data->column(c));
+
+  const double evaluations = static_cast<double>(samples.size()) * repetitions;
+  auto         report = [&](const std::string& label, double seconds, double checksum) {
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed
+              << std::setprecision(1) << std::setw(9) << seconds / evaluations * 1e9 << " ns"
+              << std::setprecision(0) << std::setw(14) << evaluations / seconds
+              << " samples/s/core   checksum " << std::setprecision(6) << checksum << "\n";
+  };
+
+  std::cout << "Samples: " << samples.size() << " x " << repetitions
+            << " (single thread, default parameters)\n\n";
+
+  for (auto defuzzifier : {fuzzy::Defuzzifier::exact(), fuzzy::Defuzzifier::sampled(101)}) {
+    fis.setDefuzzifier(defuzzifier);
+    std::string mode =
+        defuzzifier.method() == fuzzy::Defuzzifier::Method::EXACT ? "exact" : "sampled-101";
+
+    // One sample at a time through evaluate().
+    std::vector<double> x(columns.size());
+    double              checksum = 0.0;
+    auto                start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+      for (size_t i = 0; i < samples.size(); ++i) {
+        samples.gather(i, columns, x.data());
+        checksum += fis.evaluate(x.data());
+      }
+    }
+    report(mode + " evaluate()", elapsed(start), checksum);
+
+    // Whole columns through evaluateBatch() on each instruction set.
+    std::vector<double> out(samples.size());
+    for (auto isa :
+         {fuzzy::batch::Isa::SCALAR, fuzzy::batch::Isa::AVX2, fuzzy::batch::Isa::AVX512}) {
+      if (static_cast<int>(isa) > static_cast<int>(fuzzy::batch::detectIsa()))
+        continue;
+      checksum = 0.0;
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < repetitions; ++r) {
+        fis.evaluateBatch(columnPtrs.data(), samples.size(), out.data(), isa);
+        for (double v : out)
+          checksum += v;
+      }
+      report(mode + " batch " + fuzzy::batch::isaName(isa), elapsed(start), checksum);
+    }
+    std::cout << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include "fuzzy/AdsbFuzzySystem.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Frozen membership lookup tables against direct membership evaluation, default
+// parameters, for Mamdani (exact centroid) and Sugeno inference: output error
+// over the whole dataset and single-thread throughput of per-sample evaluate()
+// and evaluateBatch() at several table resolutions. "mismatch" counts samples
+// where the batch result differs from evaluate() (should be 0).
+//
+// Usage: lut_bench <adsb_csv_file> [repetitions]
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <adsb_csv_file> [repetitions]\n";
+    return 1;
+  }
+  int repetitions = (argc > 2) ? std::stoi(argv[2]) : 20;
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  auto                       data = preprocessor.loadDataset(argv[1], "results/cache");
+  const size_t               n = data->size();
+
+  auto                       fis = fuzzy::createAdsbFuzzySystem();
+  std::vector<const double*> columns;
+  for (const auto& name : fis.inputNames())
+    columns.push_back(data->column(data->featureIndex(name)));
+
+  const double evaluations = static_cast<double>(n) * repetitions;
+
+  // Per-sample outputs and ns/sample of evaluate() and evaluateBatch().
+  auto run = [&](std::vector<double>& single, std::vector<double>& batched, double& nsSingle,
+                 double& nsBatch) {
+    std::vector<double> x(columns.size());
+    single.resize(n);
+    batched.resize(n);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t v = 0; v < x.size(); ++v)
+          x[v] = columns[v][i];
+        single[i] = fis.evaluate(x.data());
+      }
+    }
+    nsSingle = elapsed(start) / evaluations * 1e9;
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+      fis.evaluateBatch(columns.data(), n, batched.data());
+    nsBatch = elapsed(start) / evaluations * 1e9;
+  };
+
+  std::cout << "Samples: " << n << " x " << repetitions << " (single thread, batch on "
+            << fuzzy::batch::isaName(fuzzy::batch::detectIsa()) << ")\n";
+
+  for (auto mode : {fuzzy::InferenceMode::MAMDANI, fuzzy::InferenceMode::SUGENO}) {
+    fis.setInferenceMode(mode);
+    fis.clearMembershipTables();
+
+    std::vector<double> reference, batched;
+    double              nsSingle, nsBatch;
+    run(reference, batched, nsSingle, nsBatch);
+
+    std::cout << "\n"
+              << (mode == fuzzy::InferenceMode::SUGENO ? "sugeno" : "mamdani exact") << "\n"
+              << std::left << std::setw(12) << "table" << std::right << std::setw(12)
+              << "max |err|" << std::setw(12) << "mean |err|" << std::setw(14) << "evaluate()"
+              << std::setw(12) << "batch" << std::setw(10) << "mismatch"
+              << "\n";
+    std::cout << std::left << std::setw(12) << "direct" << std::right << std::setw(24) << ""
+              << std::fixed << std::setprecision(1) << std::setw(11) << nsSingle << " ns"
+              << std::setw(9) << nsBatch << " ns\n";
+
+    for (size_t resolution : {33, 129, 513, 2049, 8193}) {
+      fis.freezeMembershipTables(resolution);
+      std::vector<double> single;
+      run(single, batched, nsSingle, nsBatch);
+
+      double maxErr = 0.0, sumErr = 0.0;
+      size_t mismatch = 0;
+      for (size_t i = 0; i < n; ++i) {
+        double err = std::fabs(single[i] - reference[i]);
+        maxErr = std::max(maxErr, err);
+        sumErr += err;
+        mismatch += std::memcmp(&single[i], &batched[i], sizeof(double)) != 0;
+      }
+
+      std::cout << std::left << std::setw(12) << (std::to_string(resolution) + " pt")
+                << std::right << std::scientific << std::setprecision(2) << std::setw(12)
+                << maxErr << std::setw(12) << sumErr / static_cast<double>(n) << std::fixed
+                << std::setprecision(1) << std::setw(11) << nsSingle << " ns" << std::setw(9)
+                << nsBatch << " ns" << std::setw(10) << mismatch << "\n";
+    }
+  }
+  return 0;
+}
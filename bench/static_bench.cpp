@@ -0,0 +1,75 @@
+#include "fuzzy/AdsbFuzzySystem.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Per-sample evaluate() of the generic FuzzyInferenceSystem against the
+// compile-time specialized AdsbStaticFuzzySystem, default parameters, both
+// defuzzifiers. Also checks that both engines agree bit for bit.
+//
+// Usage: static_bench <adsb_csv_file> [repetitions]
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <adsb_csv_file> [repetitions]\n";
+    return 1;
+  }
+  int repetitions = (argc > 2) ? std::stoi(argv[2]) : 20;
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  auto                       data = preprocessor.loadDataset(argv[1], "results/cache");
+
+  auto                         dynamic = fuzzy::createAdsbFuzzySystem();
+  fuzzy::AdsbStaticFuzzySystem fixed;
+
+  // Row-major copy of the inputs so both engines read identical memory.
+  const size_t        inputs = dynamic.inputNames().size();
+  const size_t        n = data->size();
+  std::vector<double> rows(n * inputs);
+  for (size_t v = 0; v < inputs; ++v) {
+    const double* column = data->column(data->featureIndex(dynamic.inputNames()[v]));
+    for (size_t i = 0; i < n; ++i)
+      rows[i * inputs + v] = column[i];
+  }
+
+  const double evaluations = static_cast<double>(n) * repetitions;
+  auto         run = [&](const std::string& label, auto& engine, std::vector<double>& out) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+      for (size_t i = 0; i < n; ++i)
+        out[i] = engine.evaluate(rows.data() + i * inputs);
+    }
+    double seconds = elapsed(start);
+    std::cout << std::left << std::setw(24) << label << std::right << std::fixed
+              << std::setprecision(1) << std::setw(9) << seconds / evaluations * 1e9 << " ns"
+              << std::setprecision(0) << std::setw(14) << evaluations / seconds
+              << " samples/s\n";
+  };
+
+  std::cout << "Samples: " << n << " x " << repetitions << " (single thread)\n\n";
+
+  for (auto defuzzifier : {fuzzy::Defuzzifier::exact(), fuzzy::Defuzzifier::sampled(101)}) {
+    std::string mode =
+        defuzzifier.method() == fuzzy::Defuzzifier::Method::EXACT ? "exact" : "sampled-101";
+    dynamic.setDefuzzifier(defuzzifier);
+    fixed.setDefuzzifier(defuzzifier);
+
+    std::vector<double> a(n), b(n);
+    run(mode + " dynamic", dynamic, a);
+    run(mode + " static", fixed, b);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i)
+      mismatches += std::memcmp(&a[i], &b[i], sizeof(double)) != 0;
+    std::cout << "  mismatching outputs: " << mismatches << "\n\n";
+  }
+  return 0;
+}
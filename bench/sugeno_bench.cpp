@@ -0,0 +1,160 @@
+#include "fuzzy/AdsbFuzzySystem.hpp"
+#include "ga/Fitness.hpp"
+#include "ga/GAEngine.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Accuracy {
+  double mse = 0.0;
+  double f1 = 0.0;
+};
+
+// MSE against the labels and F1 of "anomalous" (>= 0.5) predictions.
+static Accuracy score(const std::vector<double>& predicted, const dataset::DatasetView& samples) {
+  Accuracy acc;
+  size_t   tp = 0, fp = 0, fn = 0;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    double err = predicted[i] - samples.label(i);
+    acc.mse += err * err;
+    bool p = predicted[i] >= 0.5, a = samples.label(i) >= 0.5;
+    tp += p && a;
+    fp += p && !a;
+    fn += !p && a;
+  }
+  acc.mse /= static_cast<double>(samples.size());
+  acc.f1 = tp ? 2.0 * tp / static_cast<double>(2 * tp + fp + fn) : 0.0;
+  return acc;
+}
+
+// Mamdani (exact centroid) against zero-order Sugeno on each dataset: accuracy
+// on the last 20% of the samples, with the default chromosome and, when
+// --generations is given, with one GA-tuned per mode on the first 80%; then
+// single-thread throughput of per-sample evaluate() and evaluateBatch().
+//
+// Usage: sugeno_bench <adsb_csv_file>... [--generations N] [--repetitions N]
+int main(int argc, char* argv[]) {
+  std::vector<std::string> files;
+  int                      generations = 0;
+  int                      repetitions = 20;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--generations" && i + 1 < argc)
+      generations = std::stoi(argv[++i]);
+    else if (arg == "--repetitions" && i + 1 < argc)
+      repetitions = std::stoi(argv[++i]);
+    else
+      files.push_back(arg);
+  }
+  if (files.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " <adsb_csv_file>... [--generations N] [--repetitions N]\n";
+    return 1;
+  }
+
+  const fuzzy::InferenceMode modes[] = {fuzzy::InferenceMode::MAMDANI,
+                                        fuzzy::InferenceMode::SUGENO};
+  auto modeName = [](fuzzy::InferenceMode m) {
+    return m == fuzzy::InferenceMode::SUGENO ? "sugeno" : "mamdani";
+  };
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  for (const auto& file : files) {
+    auto data = preprocessor.loadDataset(file, "results/cache");
+    auto [trainSet, valSet] = dataset::DatasetView(data).split(0.8);
+
+    auto                fis = fuzzy::createAdsbFuzzySystem();
+    std::vector<size_t> columns;
+    for (const auto& name : fis.inputNames())
+      columns.push_back(data->featureIndex(name));
+
+    std::vector<const double*> valColumns;
+    for (size_t c : columns)
+      valColumns.push_back(valSet.column(c));
+
+    auto predict = [&](const ga::Chromosome& chromo, fuzzy::InferenceMode mode) {
+      std::vector<double> out(valSet.size());
+      fis.setParameters(chromo.genes.data());
+      fis.setInferenceMode(mode);
+      fis.evaluateBatch(valColumns.data(), valSet.size(), out.data());
+      return out;
+    };
+
+    std::cout << "\n=== " << file << " (" << trainSet.size() << " train / " << valSet.size()
+              << " validation) ===\n\n";
+    std::cout << std::left << std::setw(24) << "Accuracy" << std::right << std::setw(12)
+              << "val MSE" << std::setw(10) << "val F1"
+              << "\n";
+
+    for (auto mode : modes) {
+      std::vector<std::pair<std::string, ga::Chromosome>> chromosomes = {
+          {"default", ga::Chromosome()}};
+      if (generations > 0) {
+        ga::Fitness fitness(trainSet);
+        fitness.setInferenceMode(mode);
+        ga::GAEngine engine(50, generations, 0.8, 0.2, 3);
+        engine.setFitnessEvaluator(&fitness);
+        engine.run();
+        chromosomes.push_back({"GA-" + std::to_string(generations), engine.bestChromosome()});
+      }
+      for (const auto& [label, chromo] : chromosomes) {
+        Accuracy acc = score(predict(chromo, mode), valSet);
+        std::cout << std::left << std::setw(24) << (std::string(modeName(mode)) + " " + label)
+                  << std::right << std::fixed << std::setprecision(5) << std::setw(12) << acc.mse
+                  << std::setprecision(4) << std::setw(10) << acc.f1 << "\n";
+      }
+    }
+
+    // Throughput over the whole dataset with the default chromosome.
+    std::vector<const double*> allColumns;
+    for (size_t c : columns)
+      allColumns.push_back(data->column(c));
+    const size_t n = data->size();
+    const double evaluations = static_cast<double>(n) * repetitions;
+
+    const std::string batchHeader =
+        std::string("batch ") + fuzzy::batch::isaName(fuzzy::batch::detectIsa());
+    std::cout << "\n"
+              << std::left << std::setw(24) << "Throughput" << std::right << std::setw(12)
+              << "evaluate()" << std::setw(16) << batchHeader << "\n";
+    fis.setParameters(ga::Chromosome().genes.data());
+    for (auto mode : modes) {
+      fis.setInferenceMode(mode);
+
+      std::vector<double> x(columns.size());
+      double              checksum = 0.0;
+      auto                start = std::chrono::steady_clock::now();
+      for (int r = 0; r < repetitions; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+          for (size_t v = 0; v < x.size(); ++v)
+            x[v] = allColumns[v][i];
+          checksum += fis.evaluate(x.data());
+        }
+      }
+      double single = elapsed(start);
+
+      std::vector<double> out(n);
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < repetitions; ++r) {
+        fis.evaluateBatch(allColumns.data(), n, out.data());
+        for (double v : out)
+          checksum -= v;
+      }
+      double batched = elapsed(start);
+
+      std::cout << std::left << std::setw(24) << (std::string(modeName(mode)) + " (ns/sample)")
+                << std::right << std::fixed << std::setprecision(1) << std::setw(12)
+                << single / evaluations * 1e9 << std::setw(16) << batched / evaluations * 1e9
+                << "   checksum diff " << std::setprecision(3) << checksum << "\n";
+    }
+  }
+  return 0;
+}
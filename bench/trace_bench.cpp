@@ -0,0 +1,110 @@
+#include "fuzzy/AdsbFuzzySystem.hpp"
+#include "preprocessing/AdsbDataPreprocessor.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Cost of rule tracing in evaluate(), default parameters, single thread:
+// evaluate(x), evaluate(x, NoTrace) and evaluate(x, RuleTrace) over the whole
+// dataset. The first two are the same instantiation and should time alike; that
+// NoTrace costs nothing at all is checked by the trace_codegen_check target,
+// which compares its machine code against a build without the tracing hooks.
+// All three must return identical outputs ("mismatch" should be 0). Then prints
+// the trace of the highest-scoring sample.
+//
+// Usage: trace_bench <adsb_csv_file> [repetitions]
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <adsb_csv_file> [repetitions]\n";
+    return 1;
+  }
+  int repetitions = (argc > 2) ? std::stoi(argv[2]) : 20;
+
+  adsb::AdsbDataPreprocessor preprocessor;
+  auto                       data = preprocessor.loadDataset(argv[1], "results/cache");
+  const size_t               n = data->size();
+
+  const auto                 fis = fuzzy::createAdsbFuzzySystem();
+  const size_t               vars = fis.inputNames().size();
+  std::vector<const double*> columns;
+  for (const auto& name : fis.inputNames())
+    columns.push_back(data->column(data->featureIndex(name)));
+
+  // Row-major copy so every variant reads its inputs the same way.
+  std::vector<double> rows(n * vars);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t v = 0; v < vars; ++v)
+      rows[i * vars + v] = columns[v][i];
+  }
+
+  std::vector<double> ruleStrengths(fis.ruleCount()), termStrengths(fis.outputTermCount());
+  fuzzy::RuleTrace    trace;
+  trace.ruleStrengths = ruleStrengths.data();
+  trace.termStrengths = termStrengths.data();
+
+  // ns/sample of `score(i)` over all samples; one untimed pass warms up first.
+  auto time = [&](auto&& score) {
+    for (size_t i = 0; i < n; ++i)
+      score(i);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+      for (size_t i = 0; i < n; ++i)
+        score(i);
+    }
+    return elapsed(start) / (static_cast<double>(n) * repetitions) * 1e9;
+  };
+
+  std::vector<double> plain(n), untraced(n), traced(n);
+  double nsPlain = time([&](size_t i) { plain[i] = fis.evaluate(&rows[i * vars]); });
+  double nsUntraced = time([&](size_t i) {
+    fuzzy::NoTrace none;
+    untraced[i] = fis.evaluate(&rows[i * vars], none);
+  });
+  double nsTraced = time([&](size_t i) { traced[i] = fis.evaluate(&rows[i * vars], trace); });
+
+  size_t mismatch = 0, top = 0;
+  for (size_t i = 0; i < n; ++i) {
+    mismatch += std::memcmp(&plain[i], &untraced[i], sizeof(double)) != 0 ||
+                std::memcmp(&plain[i], &traced[i], sizeof(double)) != 0;
+    if (plain[i] > plain[top])
+      top = i;
+  }
+
+  std::cout << "Samples: " << n << " x " << repetitions << " (single thread)\n\n";
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::left << std::setw(24) << "evaluate(x)" << std::right << std::setw(8)
+            << nsPlain << " ns/sample\n";
+  std::cout << std::left << std::setw(24) << "evaluate(x, NoTrace)" << std::right << std::setw(8)
+            << nsUntraced << " ns/sample\n";
+  std::cout << std::left << std::setw(24) << "evaluate(x, RuleTrace)" << std::right
+            << std::setw(8) << nsTraced << " ns/sample\n";
+  std::cout << "mismatch: " << mismatch << "\n";
+
+  fis.evaluate(&rows[top * vars], trace);
+  std::cout << "\nTrace of sample " << top << " (output " << std::setprecision(4) << trace.output
+            << "):\n";
+  for (size_t r = 0; r < fis.ruleCount(); ++r) {
+    if (ruleStrengths[r] <= 0.0)
+      continue;
+    const auto& rule = fis.getRules()[r];
+    std::cout << "  rule " << std::setw(2) << r << "  " << ruleStrengths[r] << "  IF ";
+    for (size_t a = 0; a < rule.getAntecedents().size(); ++a) {
+      const auto& ant = rule.getAntecedents()[a];
+      std::cout << (a ? " AND " : "") << ant.variable << " is " << ant.term;
+    }
+    std::cout << " THEN " << rule.getConsequent().term << "\n";
+  }
+  std::cout << "  output terms:";
+  for (double s : termStrengths)
+    std::cout << " " << s;
+  std::cout << "\n";
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include "fuzzy/FuzzyInferenceSystem.hpp"
+
+// Compiled twice by the trace_codegen_check target: as is, and with
+// FUZZY_NO_TRACE_HOOKS, which deletes the tracing hooks from the engine. The
+// check fails unless both objects disassemble identically, i.e. tracing
+// compiled out through NoTrace leaves exactly the trace-free engine.
+
+double evaluateNoTrace(const fuzzy::FuzzyInferenceSystem& fis, const double* x) {
+  fuzzy::NoTrace none;
+  return fis.evaluate(x, none);
+}
+
+void evaluateBatchNoTrace(const fuzzy::FuzzyInferenceSystem& fis, const double* const* columns,
+                          size_t n, double* out) {
+  fis.evaluateBatch(columns, n, out, fuzzy::batch::Isa::SCALAR);
+}
@@ -1,8 +1,7 @@
 #pragma once
 
-#include "../fuzzy/AdsbFuzzyVariable.hpp"
-#include "../fuzzy/FuzzyInferenceSystem.hpp"
-#include "../fuzzy/RuleBase.hpp"
+#include "../dataset/Dataset.hpp"
+#include "../fuzzy/AdsbFuzzySystem.hpp"
 #include "../ga/Chromosome.hpp"
 
 #include <cmath>
@@ -50,12 +49,12 @@ struct ValidationMetrics {
 
 class Validator {
 public:
-  static ValidationMetrics evaluate(const std::vector<std::map<std::string, double>>& inputs,
-                                    const std::vector<double>&                        expected,
-                                    const ga::Chromosome& chromo, double threshold = 0.5) {
+  static ValidationMetrics
+  evaluate(const dataset::DatasetView& samples, const ga::Chromosome& chromo,
+           double threshold = 0.5, fuzzy::InferenceMode mode = fuzzy::InferenceMode::MAMDANI) {
 
-    auto predicted = evaluateFuzzySystem(inputs, chromo);
-    return calculateMetrics(expected, predicted, threshold);
+    auto predicted = evaluateFuzzySystem(samples, chromo, mode);
+    return calculateMetrics(labelsOf(samples), predicted, threshold);
   }
 
   static void printMetrics(const std::string& label, const ValidationMetrics& m) {
@@ -94,17 +93,16 @@ public:
     std::cout << "\n";
   }
 
-  static void
-  saveDetailedResults(const std::vector<std::map<std::string, double>>& trainInputs,
-                      const std::vector<double>&                        trainOutputs,
-                      const std::vector<std::map<std::string, double>>& valInputs,
-                      const std::vector<double>& valOutputs, const ValidationMetrics& baselineTrain,
-                      const ValidationMetrics& baselineVal, const ValidationMetrics& optTrain,
-                      const ValidationMetrics& optVal, const ga::Chromosome& optimized) {
+  static void saveDetailedResults(const dataset::DatasetView& valSamples,
+                                  const ValidationMetrics&    baselineTrain,
+                                  const ValidationMetrics&    baselineVal,
+                                  const ValidationMetrics& optTrain, const ValidationMetrics& optVal,
+                                  const ga::Chromosome& optimized,
+                                  fuzzy::InferenceMode mode = fuzzy::InferenceMode::MAMDANI) {
 
-    savePredictionsCsv(valInputs, valOutputs, optimized, "results/predictions.csv");
+    savePredictionsCsv(valSamples, optimized, "results/predictions.csv", mode);
 
-    saveErrorAnalysis(valInputs, valOutputs, optimized, "results/error_analysis.txt");
+    saveErrorAnalysis(valSamples, optimized, "results/error_analysis.txt", mode);
 
     saveMetricsSummary(baselineTrain, baselineVal, optTrain, optVal, "results/metrics_summary.txt");
 
@@ -117,42 +115,30 @@ public:
   }
 
 private:
-  static std::vector<double>
-  evaluateFuzzySystem(const std::vector<std::map<std::string, double>>& inputs,
-                      const ga::Chromosome&                             chromo) {
-
-    size_t idx = 0;
-    auto   nextGenes = [&](size_t count) -> std::vector<double> {
-      std::vector<double> v(chromo.genes.begin() + idx, chromo.genes.begin() + idx + count);
-      idx += count;
-      return v;
-    };
+  static std::vector<double> labelsOf(const dataset::DatasetView& samples) {
+    std::vector<double> labels(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+      labels[i] = samples.label(i);
+    return labels;
+  }
 
-    auto speedVar = fuzzy::createSpeedChangeVariable(nextGenes(13));
-    auto headingVar = fuzzy::createHeadingChangeVariable(nextGenes(13));
-    auto vertVar = fuzzy::createVerticalRateChangeVariable(nextGenes(13));
-    auto altVar = fuzzy::createAltitudeChangeVariable(nextGenes(13));
-    auto timeVar = fuzzy::createTimeGapVariable(nextGenes(7));
-    auto anomalyVar = fuzzy::createAnomalyLevelVariable(nextGenes(7));
-
-    fuzzy::FuzzyInferenceSystem fis;
-    fis.addInputVariable(speedVar);
-    fis.addInputVariable(headingVar);
-    fis.addInputVariable(vertVar);
-    fis.addInputVariable(altVar);
-    fis.addInputVariable(timeVar);
-    fis.setOutputVariable(anomalyVar);
-
-    for (const auto& rule : fuzzy::createAdsbRuleBase()) {
-      fis.addRule(rule);
-    }
+  static std::vector<double> evaluateFuzzySystem(const dataset::DatasetView& samples,
+                                                 const ga::Chromosome&       chromo,
+                                                 fuzzy::InferenceMode        mode) {
 
-    std::vector<double> outputs;
-    outputs.reserve(inputs.size());
+    auto fis = fuzzy::createAdsbFuzzySystem();
+    fis.setParameters(chromo.genes.data());
+    fis.setInferenceMode(mode);
 
-    for (const auto& input : inputs) {
-      outputs.push_back(fis.evaluate(input));
-    }
+    std::vector<size_t> columns;
+    for (const auto& name : fis.inputNames())
+      columns.push_back(samples.data().featureIndex(name));
+
+    std::vector<double> outputs(samples.size());
+    samples.forEachBlock(columns, 4096,
+                         [&](size_t first, size_t count, const double* const* cols) {
+                           fis.evaluateBatch(cols, count, outputs.data() + first);
+                         });
 
     return outputs;
   }
@@ -204,11 +190,19 @@ private:
     return metrics;
   }
 
-  static void savePredictionsCsv(const std::vector<std::map<std::string, double>>& inputs,
-                                 const std::vector<double>& expected, const ga::Chromosome& chromo,
-                                 const std::string& filename) {
+  static void savePredictionsCsv(const dataset::DatasetView& samples,
+                                 const ga::Chromosome& chromo, const std::string& filename,
+                                 fuzzy::InferenceMode mode) {
+
+    auto predicted = evaluateFuzzySystem(samples, chromo, mode);
+    auto expected = labelsOf(samples);
 
-    auto predicted = evaluateFuzzySystem(inputs, chromo);
+    const auto& data = samples.data();
+    size_t      speed = data.featureIndex("SpeedChange");
+    size_t      heading = data.featureIndex("HeadingChange");
+    size_t      vertRate = data.featureIndex("VerticalRateChange");
+    size_t      altitude = data.featureIndex("AltitudeChange");
+    size_t      timeGap = data.featureIndex("TimeGap");
 
     std::ofstream out(filename);
     if (!out.is_open())
@@ -217,35 +211,34 @@ private:
     out << "Index,Expected,Predicted,Error,AbsError,SpeedChange,HeadingChange,"
         << "VerticalRateChange,AltitudeChange,TimeGap\n";
 
-    for (size_t i = 0; i < inputs.size(); ++i) {
+    for (size_t i = 0; i < samples.size(); ++i) {
       double error = predicted[i] - expected[i];
       out << i << "," << expected[i] << "," << predicted[i] << "," << error << ","
-          << std::abs(error) << "," << inputs[i].at("SpeedChange") << ","
-          << inputs[i].at("HeadingChange") << "," << inputs[i].at("VerticalRateChange") << ","
-          << inputs[i].at("AltitudeChange") << "," << inputs[i].at("TimeGap") << "\n";
+          << std::abs(error) << "," << samples.feature(i, speed) << ","
+          << samples.feature(i, heading) << "," << samples.feature(i, vertRate) << ","
+          << samples.feature(i, altitude) << "," << samples.feature(i, timeGap) << "\n";
     }
 
     out.close();
   }
 
-  static void saveErrorAnalysis(const std::vector<std::map<std::string, double>>& inputs,
-                                const std::vector<double>& expected, const ga::Chromosome& chromo,
-                                const std::string& filename) {
+  static void saveErrorAnalysis(const dataset::DatasetView& samples,
+                                const ga::Chromosome& chromo, const std::string& filename,
+                                fuzzy::InferenceMode mode) {
 
-    auto predicted = evaluateFuzzySystem(inputs, chromo);
+    auto predicted = evaluateFuzzySystem(samples, chromo, mode);
+    auto expected = labelsOf(samples);
 
     struct ErrorSample {
-      size_t                        index;
-      double                        expected;
-      double                        predicted;
-      double                        absError;
-      std::map<std::string, double> inputs;
+      size_t index;
+      double expected;
+      double predicted;
+      double absError;
     };
 
     std::vector<ErrorSample> errors;
     for (size_t i = 0; i < expected.size(); ++i) {
-      errors.push_back(
-          {i, expected[i], predicted[i], std::abs(predicted[i] - expected[i]), inputs[i]});
+      errors.push_back({i, expected[i], predicted[i], std::abs(predicted[i] - expected[i])});
     }
 
     std::sort(errors.begin(), errors.end(),
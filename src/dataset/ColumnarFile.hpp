@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dataset {
+
+// On-disk layout of a columnar sample file:
+//
+//   [0, 4096)        ColumnarHeader (zero padded to one page)
+//   [4096, ...)      numFeatures feature columns followed by one label column,
+//                    each holding `columnStride` doubles (numRows padded to a
+//                    multiple of 8 so every column starts on a 64-byte boundary)
+//
+// The data section is page aligned so the file can be mapped and used in place.
+constexpr char     COLUMNAR_MAGIC[8] = {'A', 'D', 'S', 'B', 'C', 'O', 'L', '\0'};
+constexpr uint32_t COLUMNAR_VERSION = 1;
+constexpr size_t   COLUMNAR_DATA_OFFSET = 4096;
+constexpr size_t   COLUMNAR_MAX_COLUMNS = 16;
+constexpr size_t   COLUMNAR_NAME_LENGTH = 32;
+
+struct ColumnarHeader {
+  char     magic[8];
+  uint32_t version;
+  uint32_t numFeatures;
+  uint64_t numRows;
+  uint64_t columnStride;
+  uint64_t key;
+  char     names[COLUMNAR_MAX_COLUMNS][COLUMNAR_NAME_LENGTH];
+};
+
+static_assert(sizeof(ColumnarHeader) <= COLUMNAR_DATA_OFFSET, "Header must fit in one page");
+
+inline uint64_t columnarStride(uint64_t numRows) { return (numRows + 7) / 8 * 8; }
+
+class ColumnarFile {
+public:
+  // Writes `columns` (one pointer per feature, numRows values each) and labels.
+  // The file is written to a temporary name and renamed into place, so readers
+  // never observe a partially written file.
+  static void write(const std::string& path, const std::vector<std::string>& names,
+                    const std::vector<const double*>& columns, const double* labels,
+                    size_t numRows, uint64_t key) {
+    if (names.size() != columns.size() || columns.size() >= COLUMNAR_MAX_COLUMNS)
+      throw std::runtime_error("Invalid column layout for columnar file: " + path);
+
+    ColumnarHeader header = {};
+    std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    header.version = COLUMNAR_VERSION;
+    header.numFeatures = static_cast<uint32_t>(columns.size());
+    header.numRows = numRows;
+    header.columnStride = columnarStride(numRows);
+    header.key = key;
+    for (size_t c = 0; c < names.size(); ++c)
+      std::strncpy(header.names[c], names[c].c_str(), COLUMNAR_NAME_LENGTH - 1);
+
+    std::string tmpPath = path + ".tmp." + std::to_string(::getpid());
+    FILE*       f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f)
+      throw std::runtime_error("Failed to create columnar file: " + tmpPath);
+
+    std::vector<char> page(COLUMNAR_DATA_OFFSET, 0);
+    std::memcpy(page.data(), &header, sizeof(header));
+    bool ok = std::fwrite(page.data(), 1, page.size(), f) == page.size();
+
+    std::vector<double> padding(header.columnStride - numRows, 0.0);
+    auto                writeColumn = [&](const double* data) {
+      ok = ok && std::fwrite(data, sizeof(double), numRows, f) == numRows;
+      ok = ok && std::fwrite(padding.data(), sizeof(double), padding.size(), f) == padding.size();
+    };
+
+    for (const double* column : columns)
+      writeColumn(column);
+    writeColumn(labels);
+
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+      std::remove(tmpPath.c_str());
+      throw std::runtime_error("Failed to write columnar file: " + path);
+    }
+  }
+};
+
+// Read-only memory mapping of a columnar file. Column pointers stay valid for the
+// lifetime of the object.
+class MappedColumnarFile {
+public:
+  explicit MappedColumnarFile(const std::string& path) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Failed to open columnar file: " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < COLUMNAR_DATA_OFFSET) {
+      ::close(fd);
+      throw std::runtime_error("Columnar file is truncated: " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      throw std::runtime_error("Failed to map columnar file: " + path);
+    base_ = static_cast<const char*>(addr);
+
+    std::memcpy(&header_, base_, sizeof(header_));
+    size_t expected = COLUMNAR_DATA_OFFSET + (header_.numFeatures + 1) * header_.columnStride *
+                                                 sizeof(double);
+    if (std::memcmp(header_.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0 ||
+        header_.version != COLUMNAR_VERSION || header_.numFeatures >= COLUMNAR_MAX_COLUMNS ||
+        header_.columnStride != columnarStride(header_.numRows) || size_ != expected) {
+      ::munmap(addr, size_);
+      throw std::runtime_error("Invalid columnar file: " + path);
+    }
+  }
+
+  ~MappedColumnarFile() { ::munmap(const_cast<char*>(base_), size_); }
+
+  MappedColumnarFile(const MappedColumnarFile&) = delete;
+  MappedColumnarFile& operator=(const MappedColumnarFile&) = delete;
+
+  const std::string& path() const { return path_; }
+  size_t             rows() const { return header_.numRows; }
+  size_t             features() const { return header_.numFeatures; }
+  uint64_t           key() const { return header_.key; }
+  std::string        name(size_t c) const { return header_.names[c]; }
+
+  const double* column(size_t c) const {
+    return reinterpret_cast<const double*>(base_ + COLUMNAR_DATA_OFFSET) +
+           c * header_.columnStride;
+  }
+
+  const double* labels() const { return column(header_.numFeatures); }
+
+private:
+  std::string    path_;
+  ColumnarHeader header_;
+  const char*    base_ = nullptr;
+  size_t         size_ = 0;
+};
+
+// One block of consecutive rows, laid out column by column.
+struct ColumnarBlock {
+  size_t              firstRow = 0;
+  size_t              rows = 0;
+  size_t              capacity = 0;
+  size_t              numFeatures = 0;
+  std::vector<double> data;
+
+  const double* column(size_t c) const { return data.data() + c * capacity; }
+  const double* labels() const { return column(numFeatures); }
+};
+
+// Streams rows [beginRow, endRow) of a columnar file in large sequential blocks.
+// A background thread reads ahead into a small ring of buffers while the caller
+// works on the current block, so disk reads overlap with computation. Only
+// `prefetchDepth + 1` blocks are ever resident. rewind() starts another pass
+// over the same rows with the same buffers and thread.
+class ColumnarBlockReader {
+public:
+  ColumnarBlockReader(const std::string& path, size_t beginRow, size_t endRow, size_t blockRows,
+                      size_t prefetchDepth = 2)
+      : path_(path), begin_(beginRow), next_(beginRow), end_(endRow), blockRows_(blockRows) {
+    if (blockRows_ == 0)
+      throw std::runtime_error("Block size must be > 0");
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+      throw std::runtime_error("Failed to open columnar file: " + path);
+    if (::pread(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_)) ||
+        std::memcmp(header_.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0 ||
+        header_.version != COLUMNAR_VERSION || header_.numFeatures >= COLUMNAR_MAX_COLUMNS) {
+      ::close(fd_);
+      throw std::runtime_error("Invalid columnar file: " + path);
+    }
+    if (endRow > header_.numRows || beginRow > endRow) {
+      ::close(fd_);
+      throw std::runtime_error("Row range out of bounds for columnar file: " + path);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    slots_.resize(prefetchDepth + 1);
+    for (auto& slot : slots_) {
+      slot.block.capacity = blockRows_;
+      slot.block.numFeatures = header_.numFeatures;
+      slot.block.data.resize((header_.numFeatures + 1) * blockRows_);
+    }
+    producer_ = std::thread([this] { readAhead(); });
+  }
+
+  ~ColumnarBlockReader() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    producer_.join();
+    ::close(fd_);
+  }
+
+  ColumnarBlockReader(const ColumnarBlockReader&) = delete;
+  ColumnarBlockReader& operator=(const ColumnarBlockReader&) = delete;
+
+  size_t      features() const { return header_.numFeatures; }
+  std::string name(size_t c) const { return header_.names[c]; }
+
+  // Back to the first row. The thread starts reading ahead again at once, so
+  // rewinding right after a pass overlaps the next pass's first reads with
+  // whatever the caller does in between.
+  void rewind() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return !reading_; });
+    for (auto& slot : slots_)
+      slot.state = Slot::FREE;
+    next_ = begin_;
+    fill_ = 0;
+    current_ = NONE;
+    done_ = false;
+    error_ = false;
+    cv_.notify_all();
+  }
+
+  // Returns the next block, or nullptr once the range is exhausted. The block
+  // returned by the previous call is handed back to the read-ahead thread.
+  const ColumnarBlock* next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (current_ != NONE) {
+      slots_[current_].state = Slot::FREE;
+      current_ = (current_ + 1) % slots_.size();
+      cv_.notify_all();
+    } else {
+      current_ = 0;
+    }
+
+    cv_.wait(lock, [&] { return slots_[current_].state != Slot::FREE || error_ || done_; });
+    if (error_)
+      throw std::runtime_error("Failed to read columnar file: " + path_);
+    if (slots_[current_].state != Slot::READY)
+      return nullptr;
+    return &slots_[current_].block;
+  }
+
+private:
+  struct Slot {
+    enum State { FREE, READY, END } state = FREE;
+    ColumnarBlock block;
+  };
+
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  std::string             path_;
+  int                     fd_ = -1;
+  ColumnarHeader          header_;
+  size_t                  begin_;
+  size_t                  next_; // written by the thread only while reading_
+  size_t                  end_;
+  size_t                  blockRows_;
+  std::vector<Slot>       slots_;
+  size_t                  current_ = NONE; // slot held by the caller
+  size_t                  fill_ = 0;       // slot the thread fills next
+  bool                    stop_ = false;
+  bool                    done_ = false;
+  bool                    error_ = false;
+  bool                    reading_ = false; // thread is reading without the lock
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  std::thread             producer_;
+
+  bool readBlock(ColumnarBlock& block) {
+    block.firstRow = next_;
+    block.rows = std::min(blockRows_, end_ - next_);
+    size_t bytes = block.rows * sizeof(double);
+    for (size_t c = 0; c <= header_.numFeatures; ++c) {
+      off_t   offset = static_cast<off_t>(COLUMNAR_DATA_OFFSET +
+                                        (c * header_.columnStride + next_) * sizeof(double));
+      char*   dst = reinterpret_cast<char*>(block.data.data() + c * blockRows_);
+      size_t  done = 0;
+      while (done < bytes) {
+        ssize_t n = ::pread(fd_, dst + done, bytes - done, offset + static_cast<off_t>(done));
+        if (n <= 0)
+          return false;
+        done += static_cast<size_t>(n);
+      }
+    }
+    next_ += block.rows;
+    return true;
+  }
+
+  // Fills slots until the range is exhausted, then waits for rewind().
+  void readAhead() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      cv_.wait(lock, [&] {
+        return stop_ || (!done_ && !error_ && slots_[fill_].state == Slot::FREE);
+      });
+      if (stop_)
+        return;
+
+      const size_t slot = fill_;
+      const bool   more = next_ < end_;
+      reading_ = true;
+      lock.unlock();
+      bool ok = !more || readBlock(slots_[slot].block);
+      lock.lock();
+      reading_ = false;
+
+      if (!ok)
+        error_ = true;
+      else if (!more)
+        done_ = true;
+      slots_[slot].state = more ? Slot::READY : Slot::END;
+      fill_ = (fill_ + 1) % slots_.size();
+      cv_.notify_all();
+    }
+  }
+};
+} // namespace dataset
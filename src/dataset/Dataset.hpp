@@ -0,0 +1,209 @@
+#pragma once
+
+#include "ColumnarFile.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dataset {
+
+// Immutable, column-major set of training samples. Instances are only handed out
+// through std::shared_ptr<const Dataset>, so any number of views, GA runs and
+// validators can share one copy of the data.
+class Dataset {
+public:
+  // Copies row maps into columnar storage, in the order given by `featureNames`.
+  static std::shared_ptr<const Dataset>
+  fromSamples(const std::vector<std::string>&                   featureNames,
+              const std::vector<std::map<std::string, double>>& inputs,
+              const std::vector<double>&                        labels) {
+    if (inputs.size() != labels.size())
+      throw std::runtime_error("Inputs and labels size mismatch");
+
+    std::shared_ptr<Dataset> data(new Dataset());
+    data->names_ = featureNames;
+    data->rows_ = inputs.size();
+    data->storage_.resize((featureNames.size() + 1) * data->rows_);
+
+    for (size_t f = 0; f < featureNames.size(); ++f) {
+      double* column = data->storage_.data() + f * data->rows_;
+      for (size_t i = 0; i < inputs.size(); ++i)
+        column[i] = inputs[i].at(featureNames[f]);
+    }
+    std::copy(labels.begin(), labels.end(),
+              data->storage_.begin() + featureNames.size() * data->rows_);
+
+    for (size_t f = 0; f <= featureNames.size(); ++f)
+      data->columns_.push_back(data->storage_.data() + f * data->rows_);
+    return data;
+  }
+
+  // Uses a memory-mapped columnar file in place; nothing is copied.
+  static std::shared_ptr<const Dataset>
+  fromMapped(std::shared_ptr<const MappedColumnarFile> file) {
+    std::shared_ptr<Dataset> data(new Dataset());
+    data->rows_ = file->rows();
+    for (size_t f = 0; f < file->features(); ++f) {
+      data->names_.push_back(file->name(f));
+      data->columns_.push_back(file->column(f));
+    }
+    data->columns_.push_back(file->labels());
+    data->mapped_ = std::move(file);
+    return data;
+  }
+
+  size_t size() const { return rows_; }
+  size_t features() const { return names_.size(); }
+
+  const std::vector<std::string>& featureNames() const { return names_; }
+
+  size_t featureIndex(const std::string& name) const {
+    for (size_t f = 0; f < names_.size(); ++f) {
+      if (names_[f] == name)
+        return f;
+    }
+    throw std::runtime_error("Feature not found in dataset: " + name);
+  }
+
+  const double* column(size_t f) const { return columns_[f]; }
+  const double* labels() const { return columns_[names_.size()]; }
+
+  // Path of the backing columnar file, or empty for an in-memory dataset.
+  std::string sourceFile() const { return mapped_ ? mapped_->path() : std::string(); }
+
+private:
+  Dataset() = default;
+
+  std::vector<std::string>                  names_;
+  size_t                                    rows_ = 0;
+  std::vector<double>                       storage_;
+  std::shared_ptr<const MappedColumnarFile> mapped_;
+  std::vector<const double*>                columns_;
+};
+
+// Lightweight selection of rows from a shared Dataset: either a contiguous span
+// or an explicit index list. Copying a view never copies sample data.
+class DatasetView {
+public:
+  DatasetView() = default;
+
+  explicit DatasetView(std::shared_ptr<const Dataset> data)
+      : data_(std::move(data)), begin_(0), end_(data_ ? data_->size() : 0) {}
+
+  DatasetView(std::shared_ptr<const Dataset> data, size_t begin, size_t end)
+      : data_(std::move(data)), begin_(begin), end_(end) {
+    if (!data_ || begin_ > end_ || end_ > data_->size())
+      throw std::runtime_error("Invalid dataset view range");
+  }
+
+  DatasetView(std::shared_ptr<const Dataset> data, std::shared_ptr<const std::vector<size_t>> rows)
+      : data_(std::move(data)), indices_(std::move(rows)) {
+    for (size_t r : *indices_) {
+      if (r >= data_->size())
+        throw std::runtime_error("Dataset view index out of range");
+    }
+  }
+
+  size_t size() const { return indices_ ? indices_->size() : end_ - begin_; }
+  bool   empty() const { return size() == 0; }
+  bool   contiguous() const { return !indices_; }
+
+  const Dataset&                 data() const { return *data_; }
+  std::shared_ptr<const Dataset> dataPtr() const { return data_; }
+
+  // Row of the underlying dataset that backs view row `i`.
+  size_t rowIndex(size_t i) const { return indices_ ? (*indices_)[i] : begin_ + i; }
+
+  double feature(size_t i, size_t f) const { return data_->column(f)[rowIndex(i)]; }
+  double label(size_t i) const { return data_->labels()[rowIndex(i)]; }
+
+  // Direct column access for contiguous views (first element is view row 0).
+  const double* column(size_t f) const { return data_->column(f) + begin_; }
+  const double* labels() const { return data_->labels() + begin_; }
+
+  // Writes the features of row `i` in the order given by `columns`.
+  void gather(size_t i, const std::vector<size_t>& columns, double* out) const {
+    size_t row = rowIndex(i);
+    for (size_t c = 0; c < columns.size(); ++c)
+      out[c] = data_->column(columns[c])[row];
+  }
+
+  // Calls fn(first, count, cols) over consecutive row ranges covering the view,
+  // where cols[c] points at `count` values of dataset column columns[c].
+  // Contiguous views hand out the dataset's own storage in one call; index views
+  // are gathered into a scratch buffer `blockRows` rows at a time.
+  template <typename Fn>
+  void forEachBlock(const std::vector<size_t>& columns, size_t blockRows, Fn&& fn) const {
+    std::vector<const double*> cols(columns.size());
+    if (contiguous()) {
+      for (size_t c = 0; c < columns.size(); ++c)
+        cols[c] = column(columns[c]);
+      fn(size_t(0), size(), cols.data());
+      return;
+    }
+
+    std::vector<double> buffer(columns.size() * blockRows);
+    for (size_t first = 0; first < size(); first += blockRows) {
+      size_t count = std::min(blockRows, size() - first);
+      for (size_t c = 0; c < columns.size(); ++c) {
+        double* dst = buffer.data() + c * blockRows;
+        for (size_t i = 0; i < count; ++i)
+          dst[i] = feature(first + i, columns[c]);
+        cols[c] = dst;
+      }
+      fn(first, count, cols.data());
+    }
+  }
+
+  std::map<std::string, double> row(size_t i) const {
+    std::map<std::string, double> values;
+    for (size_t f = 0; f < data_->features(); ++f)
+      values[data_->featureNames()[f]] = feature(i, f);
+    return values;
+  }
+
+  DatasetView slice(size_t begin, size_t end) const {
+    if (begin > end || end > size())
+      throw std::runtime_error("Invalid dataset slice");
+    if (contiguous())
+      return DatasetView(data_, begin_ + begin, begin_ + end);
+    return DatasetView(data_, std::make_shared<const std::vector<size_t>>(
+                                  indices_->begin() + begin, indices_->begin() + end));
+  }
+
+  // Leading `fraction` of the rows and the remainder (train/validation split).
+  std::pair<DatasetView, DatasetView> split(double fraction) const {
+    size_t cut = static_cast<size_t>(size() * fraction);
+    return {slice(0, cut), slice(cut, size())};
+  }
+
+  // k-th of `numFolds` folds: (training rows, held-out rows).
+  std::pair<DatasetView, DatasetView> fold(size_t k, size_t numFolds) const {
+    if (numFolds == 0 || k >= numFolds)
+      throw std::runtime_error("Invalid fold index");
+
+    size_t begin = size() * k / numFolds;
+    size_t end = size() * (k + 1) / numFolds;
+
+    auto rows = std::make_shared<std::vector<size_t>>();
+    rows->reserve(size() - (end - begin));
+    for (size_t i = 0; i < size(); ++i) {
+      if (i < begin || i >= end)
+        rows->push_back(rowIndex(i));
+    }
+    return {DatasetView(data_, std::shared_ptr<const std::vector<size_t>>(std::move(rows))),
+            slice(begin, end)};
+  }
+
+private:
+  std::shared_ptr<const Dataset>             data_;
+  std::shared_ptr<const std::vector<size_t>> indices_;
+  size_t                                     begin_ = 0;
+  size_t                                     end_ = 0;
+};
+} // namespace dataset
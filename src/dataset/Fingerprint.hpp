@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dataset {
+
+// 64-bit FNV-1a, used to derive content-addressed keys for cached data.
+class Fingerprint {
+public:
+  void update(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+
+  void update(double value) { update(&value, sizeof(value)); }
+  void update(uint64_t value) { update(&value, sizeof(value)); }
+  void update(const std::string& value) { update(value.data(), value.size()); }
+
+  uint64_t value() const { return hash_; }
+
+  // Hashes the full contents of a file, so a cache key changes whenever the
+  // input changes regardless of timestamps.
+  static uint64_t ofFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+      throw std::runtime_error("Failed to open file for fingerprinting: " + path);
+
+    Fingerprint       fp;
+    std::vector<char> buffer(1 << 20);
+    uint64_t          total = 0;
+    while (file) {
+      file.read(buffer.data(), buffer.size());
+      std::streamsize n = file.gcount();
+      fp.update(buffer.data(), static_cast<size_t>(n));
+      total += static_cast<uint64_t>(n);
+    }
+    fp.update(total);
+    return fp.value();
+  }
+
+private:
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+} // namespace dataset
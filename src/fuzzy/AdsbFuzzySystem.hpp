@@ -0,0 +1,103 @@
+#pragma once
+
+#include "AdsbFuzzyVariable.hpp"
+#include "FuzzyInferenceSystem.hpp"
+#include "RuleBase.hpp"
+#include "StaticFuzzySystem.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <string_view>
+
+namespace fuzzy {
+
+// Complete ADS-B system with default membership parameters. Its parameter layout
+// (see FuzzyInferenceSystem::setParameters) matches the 66-gene chromosome:
+// SpeedChange(13), HeadingChange(13), VerticalRateChange(13), AltitudeChange(13),
+// TimeGap(7), AnomalyLevel(7).
+inline FuzzyInferenceSystem createAdsbFuzzySystem() {
+  FuzzyInferenceSystem fis;
+  fis.addInputVariable(createSpeedChangeVariable());
+  fis.addInputVariable(createHeadingChangeVariable());
+  fis.addInputVariable(createVerticalRateChangeVariable());
+  fis.addInputVariable(createAltitudeChangeVariable());
+  fis.addInputVariable(createTimeGapVariable());
+  fis.setOutputVariable(createAnomalyLevelVariable());
+
+  for (const auto& rule : createAdsbRuleBase())
+    fis.addRule(rule);
+
+  return fis;
+}
+
+namespace detail {
+
+// Variable and term names in the order of AdsbTopology's term indices.
+inline constexpr std::array<std::string_view, 5> ADSB_INPUTS = {
+    "SpeedChange", "HeadingChange", "VerticalRateChange", "AltitudeChange", "TimeGap"};
+inline constexpr std::array<std::string_view, 5> ADSB_DELTA_TERMS = {
+    "Negative_Large", "Negative", "Zero", "Positive", "Positive_Large"};
+inline constexpr std::array<std::string_view, 3> ADSB_TIME_GAP_TERMS = {"Small", "Medium",
+                                                                        "Large"};
+inline constexpr std::array<std::string_view, 3> ADSB_OUTPUT_TERMS = {"Low", "Medium", "High"};
+
+// Index of `name` in `names`. Thrown during constant evaluation, so a rule
+// naming an unknown variable or term fails to compile.
+template <size_t N>
+constexpr int nameIndex(const std::array<std::string_view, N>& names, std::string_view name) {
+  for (size_t i = 0; i < N; ++i) {
+    if (names[i] == name)
+      return static_cast<int>(i);
+  }
+  throw std::logic_error("ADS-B rule names an unknown variable or term");
+}
+
+// ADSB_RULES as term indices, one column per input.
+constexpr std::array<StaticRule<5>, ADSB_RULES.size()> compileAdsbRules() {
+  std::array<StaticRule<5>, ADSB_RULES.size()> rules{};
+  for (size_t r = 0; r < ADSB_RULES.size(); ++r) {
+    for (int& term : rules[r].terms)
+      term = NO_TERM;
+    for (const RuleTermName& a : ADSB_RULES[r].antecedents) {
+      if (a.variable.empty())
+        continue;
+      const int v = nameIndex(ADSB_INPUTS, a.variable);
+      rules[r].terms[v] = v == 4 ? nameIndex(ADSB_TIME_GAP_TERMS, a.term)
+                                 : nameIndex(ADSB_DELTA_TERMS, a.term);
+    }
+    if (ADSB_RULES[r].consequent.variable != "AnomalyLevel")
+      throw std::logic_error("ADS-B rule concludes on an unknown variable");
+    rules[r].consequent = nameIndex(ADSB_OUTPUT_TERMS, ADSB_RULES[r].consequent.term);
+  }
+  return rules;
+}
+
+} // namespace detail
+
+// Compile-time description of the same system for StaticFuzzySystem.
+struct AdsbTopology {
+  static constexpr MFType Z = MFType::Z_SHAPE;
+  static constexpr MFType T = MFType::TRIANGLE;
+  static constexpr MFType S = MFType::S_SHAPE;
+
+  // SpeedChange, HeadingChange, VerticalRateChange, AltitudeChange, TimeGap.
+  static constexpr std::array<size_t, 5>  TERM_COUNTS = {5, 5, 5, 5, 3};
+  static constexpr std::array<MFType, 23> INPUT_TYPES = {Z, T, T, T, S, Z, T, T, T, S, Z, T,
+                                                         T, T, S, Z, T, T, T, S, Z, T, S};
+  static constexpr std::array<MFType, 3>  OUTPUT_TYPES = {Z, T, S};
+
+  // Built from ADSB_RULES, the table createAdsbRuleBase() reads, so the two
+  // engines cannot drift apart; columns follow TERM_COUNTS.
+  static constexpr auto RULES = detail::compileAdsbRules();
+
+  static std::vector<FuzzyVariable> inputVariables() {
+    return {createSpeedChangeVariable(), createHeadingChangeVariable(),
+            createVerticalRateChangeVariable(), createAltitudeChangeVariable(),
+            createTimeGapVariable()};
+  }
+
+  static FuzzyVariable outputVariable() { return createAnomalyLevelVariable(); }
+};
+
+using AdsbStaticFuzzySystem = StaticFuzzySystem<AdsbTopology>;
+} // namespace fuzzy
@@ -15,11 +15,11 @@ inline FuzzyVariable createSpeedChangeVariable(const std::vector<double>& params
   var.min = -10.0;
   var.max = 10.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Negative", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"Zero", MFType::TRIANGLE, {params[5], params[6], params[7]}},
-             {"Positive", MFType::TRIANGLE, {params[8], params[9], params[10]}},
-             {"Positive_Large", MFType::S_SHAPE, {params[11], params[12]}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Negative", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("Zero", MFType::TRIANGLE, {params[5], params[6], params[7]});
+  var.addTerm("Positive", MFType::TRIANGLE, {params[8], params[9], params[10]});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {params[11], params[12]});
 
   return var;
 }
@@ -34,11 +34,11 @@ inline FuzzyVariable createHeadingChangeVariable(const std::vector<double>& para
   var.min = -180.0;
   var.max = 180.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Negative", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"Zero", MFType::TRIANGLE, {params[5], params[6], params[7]}},
-             {"Positive", MFType::TRIANGLE, {params[8], params[9], params[10]}},
-             {"Positive_Large", MFType::S_SHAPE, {params[11], params[12]}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Negative", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("Zero", MFType::TRIANGLE, {params[5], params[6], params[7]});
+  var.addTerm("Positive", MFType::TRIANGLE, {params[8], params[9], params[10]});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {params[11], params[12]});
 
   return var;
 }
@@ -53,11 +53,11 @@ inline FuzzyVariable createVerticalRateChangeVariable(const std::vector<double>&
   var.min = -20.0;
   var.max = 20.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Negative", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"Zero", MFType::TRIANGLE, {params[5], params[6], params[7]}},
-             {"Positive", MFType::TRIANGLE, {params[8], params[9], params[10]}},
-             {"Positive_Large", MFType::S_SHAPE, {params[11], params[12]}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Negative", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("Zero", MFType::TRIANGLE, {params[5], params[6], params[7]});
+  var.addTerm("Positive", MFType::TRIANGLE, {params[8], params[9], params[10]});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {params[11], params[12]});
 
   return var;
 }
@@ -72,11 +72,11 @@ inline FuzzyVariable createAltitudeChangeVariable(const std::vector<double>& par
   var.min = -1000.0;
   var.max = 1000.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Negative", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"Zero", MFType::TRIANGLE, {params[5], params[6], params[7]}},
-             {"Positive", MFType::TRIANGLE, {params[8], params[9], params[10]}},
-             {"Positive_Large", MFType::S_SHAPE, {params[11], params[12]}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Negative", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("Zero", MFType::TRIANGLE, {params[5], params[6], params[7]});
+  var.addTerm("Positive", MFType::TRIANGLE, {params[8], params[9], params[10]});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {params[11], params[12]});
 
   return var;
 }
@@ -91,9 +91,9 @@ inline FuzzyVariable createTimeGapVariable(const std::vector<double>& params) {
   var.min = 0.0;
   var.max = 60.0;
 
-  var.mfs = {{"Small", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Medium", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"Large", MFType::S_SHAPE, {params[5], params[6]}}};
+  var.addTerm("Small", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Medium", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("Large", MFType::S_SHAPE, {params[5], params[6]});
 
   return var;
 }
@@ -108,9 +108,9 @@ inline FuzzyVariable createAnomalyLevelVariable(const std::vector<double>& param
   var.min = 0.0;
   var.max = 1.0;
 
-  var.mfs = {{"Low", MFType::Z_SHAPE, {params[0], params[1]}},
-             {"Medium", MFType::TRIANGLE, {params[2], params[3], params[4]}},
-             {"High", MFType::S_SHAPE, {params[5], params[6]}}};
+  var.addTerm("Low", MFType::Z_SHAPE, {params[0], params[1]});
+  var.addTerm("Medium", MFType::TRIANGLE, {params[2], params[3], params[4]});
+  var.addTerm("High", MFType::S_SHAPE, {params[5], params[6]});
 
   return var;
 }
@@ -120,11 +120,11 @@ inline FuzzyVariable createSpeedChangeVariable() {
   var.min = -10.0;
   var.max = 10.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {-6.0, -3.0}},
-             {"Negative", MFType::TRIANGLE, {-6.0, -3.0, 0.0}},
-             {"Zero", MFType::TRIANGLE, {-1.0, 0.0, 1.0}},
-             {"Positive", MFType::TRIANGLE, {0.0, 3.0, 6.0}},
-             {"Positive_Large", MFType::S_SHAPE, {3.0, 6.0}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {-6.0, -3.0});
+  var.addTerm("Negative", MFType::TRIANGLE, {-6.0, -3.0, 0.0});
+  var.addTerm("Zero", MFType::TRIANGLE, {-1.0, 0.0, 1.0});
+  var.addTerm("Positive", MFType::TRIANGLE, {0.0, 3.0, 6.0});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {3.0, 6.0});
 
   return var;
 }
@@ -135,11 +135,11 @@ inline FuzzyVariable createHeadingChangeVariable() {
   var.min = -180.0;
   var.max = 180.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {-90.0, -30.0}},
-             {"Negative", MFType::TRIANGLE, {-60.0, -20.0, 0.0}},
-             {"Zero", MFType::TRIANGLE, {-5.0, 0.0, 5.0}},
-             {"Positive", MFType::TRIANGLE, {0.0, 20.0, 60.0}},
-             {"Positive_Large", MFType::S_SHAPE, {30.0, 90.0}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {-90.0, -30.0});
+  var.addTerm("Negative", MFType::TRIANGLE, {-60.0, -20.0, 0.0});
+  var.addTerm("Zero", MFType::TRIANGLE, {-5.0, 0.0, 5.0});
+  var.addTerm("Positive", MFType::TRIANGLE, {0.0, 20.0, 60.0});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {30.0, 90.0});
 
   return var;
 }
@@ -150,11 +150,11 @@ inline FuzzyVariable createVerticalRateChangeVariable() {
   var.min = -20.0;
   var.max = 20.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {-10.0, -5.0}},
-             {"Negative", MFType::TRIANGLE, {-10.0, -5.0, 0.0}},
-             {"Zero", MFType::TRIANGLE, {-1.0, 0.0, 1.0}},
-             {"Positive", MFType::TRIANGLE, {0.0, 5.0, 10.0}},
-             {"Positive_Large", MFType::S_SHAPE, {5.0, 10.0}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {-10.0, -5.0});
+  var.addTerm("Negative", MFType::TRIANGLE, {-10.0, -5.0, 0.0});
+  var.addTerm("Zero", MFType::TRIANGLE, {-1.0, 0.0, 1.0});
+  var.addTerm("Positive", MFType::TRIANGLE, {0.0, 5.0, 10.0});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {5.0, 10.0});
 
   return var;
 }
@@ -165,11 +165,11 @@ inline FuzzyVariable createAltitudeChangeVariable() {
   var.min = -1000.0;
   var.max = 1000.0;
 
-  var.mfs = {{"Negative_Large", MFType::Z_SHAPE, {-500.0, -100.0}},
-             {"Negative", MFType::TRIANGLE, {-500.0, -100.0, 0.0}},
-             {"Zero", MFType::TRIANGLE, {-50.0, 0.0, 50.0}},
-             {"Positive", MFType::TRIANGLE, {0.0, 100.0, 500.0}},
-             {"Positive_Large", MFType::S_SHAPE, {100.0, 500.0}}};
+  var.addTerm("Negative_Large", MFType::Z_SHAPE, {-500.0, -100.0});
+  var.addTerm("Negative", MFType::TRIANGLE, {-500.0, -100.0, 0.0});
+  var.addTerm("Zero", MFType::TRIANGLE, {-50.0, 0.0, 50.0});
+  var.addTerm("Positive", MFType::TRIANGLE, {0.0, 100.0, 500.0});
+  var.addTerm("Positive_Large", MFType::S_SHAPE, {100.0, 500.0});
 
   return var;
 }
@@ -180,9 +180,9 @@ inline FuzzyVariable createTimeGapVariable() {
   var.min = 0.0;
   var.max = 60.0;
 
-  var.mfs = {{"Small", MFType::Z_SHAPE, {1.0, 5.0}},
-             {"Medium", MFType::TRIANGLE, {3.0, 10.0, 20.0}},
-             {"Large", MFType::S_SHAPE, {15.0, 30.0}}};
+  var.addTerm("Small", MFType::Z_SHAPE, {1.0, 5.0});
+  var.addTerm("Medium", MFType::TRIANGLE, {3.0, 10.0, 20.0});
+  var.addTerm("Large", MFType::S_SHAPE, {15.0, 30.0});
 
   return var;
 }
@@ -193,9 +193,9 @@ inline FuzzyVariable createAnomalyLevelVariable() {
   var.min = 0.0;
   var.max = 1.0;
 
-  var.mfs = {{"Low", MFType::Z_SHAPE, {0.2, 0.4}},
-             {"Medium", MFType::TRIANGLE, {0.2, 0.5, 0.8}},
-             {"High", MFType::S_SHAPE, {0.6, 0.8}}};
+  var.addTerm("Low", MFType::Z_SHAPE, {0.2, 0.4});
+  var.addTerm("Medium", MFType::TRIANGLE, {0.2, 0.5, 0.8});
+  var.addTerm("High", MFType::S_SHAPE, {0.6, 0.8});
 
   return var;
 }
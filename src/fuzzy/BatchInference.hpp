@@ -0,0 +1,399 @@
+#pragma once
+
+#include "Defuzzifier.hpp"
+#include "FuzzyVariable.hpp"
+#include "MembershipTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Lane-parallel kernels behind FuzzyInferenceSystem::evaluateBatch().
+//
+// The kernels are written once against GCC/Clang vector extensions and
+// instantiated for 4 lanes (AVX2) and 8 lanes (AVX-512) inside functions
+// carrying the matching target attribute, so a generic build still gets the
+// wide code paths; the widest one the CPU supports is picked at run time.
+// Every operation mirrors the scalar engine step for step, so batch results are
+// bit-identical to evaluate().
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FUZZY_BATCH_SIMD 1
+#define FUZZY_BATCH_INLINE inline __attribute__((always_inline))
+// Fusing a*b+c must follow the scalar build, otherwise results drift by an ulp:
+// when the base build has no FMA, contraction is switched off in the kernels
+// (AVX-512F always carries FMA).
+#ifdef __FMA__
+#define FUZZY_BATCH_AVX2 __attribute__((target("avx2,fma")))
+#define FUZZY_BATCH_AVX512 __attribute__((target("avx512f")))
+#else
+#define FUZZY_BATCH_AVX2 __attribute__((target("avx2"), optimize("fp-contract=off")))
+#define FUZZY_BATCH_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#endif
+#endif
+
+namespace fuzzy {
+
+// Upper bound on the total number of input terms (degrees table size).
+constexpr size_t MAX_INPUT_TERMS = 64;
+
+namespace batch {
+
+enum class Isa { SCALAR, AVX2, AVX512 };
+
+// Widest instruction set usable on this CPU.
+inline Isa detectIsa() {
+#ifdef FUZZY_BATCH_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return Isa::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return Isa::AVX2;
+#endif
+  return Isa::SCALAR;
+}
+
+inline const char* isaName(Isa isa) {
+  switch (isa) {
+  case Isa::AVX512:
+    return "AVX-512";
+  case Isa::AVX2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+
+// Flattened model handed to the kernels. Term slots follow the engine's degrees
+// table; the rule arrays point into the engine's compiled rules.
+struct Layout {
+  size_t                                        numInputs = 0;
+  std::array<uint32_t, MAX_INPUT_TERMS + 1>     termBegin{}; // per input, plus end
+  std::array<MFType, MAX_INPUT_TERMS>           type{};
+  std::array<std::array<double, 4>, MAX_INPUT_TERMS> params{};
+  const MembershipTable* tables = nullptr; // per input when frozen; replaces type/params
+  const double* const*   termColumns = nullptr; // per slot when degrees are precomputed
+
+  size_t          numRules = 0;
+  const uint32_t* ruleBegin = nullptr;   // numRules + 1 offsets into slots
+  const uint32_t* slots = nullptr;       // degrees-table slot per antecedent
+  const uint32_t* consequent = nullptr;  // output term per rule
+
+  const FuzzyVariable* output = nullptr;
+  const Defuzzifier*   defuzzifier = nullptr;
+
+  // Zero-order Sugeno inference: consequent constant per output term.
+  bool          sugeno = false;
+  const double* sugenoConstants = nullptr;
+
+  // SAMPLED defuzzification only: grid points and output memberships at them
+  // (term-major), both independent of the sample.
+  std::vector<double> gridX;
+  std::vector<double> gridMu;
+
+  void prepareGrid() {
+    gridX.clear();
+    gridMu.clear();
+    if (defuzzifier->method() != Defuzzifier::Method::SAMPLED)
+      return;
+
+    size_t n = defuzzifier->resolution();
+    double step = (output->max - output->min) / static_cast<double>(n - 1);
+    for (size_t i = 0; i < n; ++i)
+      gridX.push_back(output->min + static_cast<double>(i) * step);
+    for (const auto& mf : output->mfs) {
+      for (double x : gridX)
+        gridMu.push_back(mf.evaluate(x));
+    }
+  }
+};
+
+#ifdef FUZZY_BATCH_SIMD
+
+typedef double Vec4 __attribute__((vector_size(32)));
+typedef double Vec8 __attribute__((vector_size(64)));
+
+// The helpers are not target functions themselves, so vectors only cross
+// their signatures by reference: a Vec4/Vec8 taken or returned by value would
+// have a different ABI with and without AVX (GCC's -Wpsabi warning).
+
+template <typename V>
+FUZZY_BATCH_INLINE void setAll(V& v, double s) {
+  for (size_t l = 0; l < sizeof(V) / sizeof(double); ++l)
+    v[l] = s;
+}
+
+// In place, with the same comparisons as a = std::min(a, b) / std::max(a, b),
+// so ties and NaNs resolve identically.
+template <typename V>
+FUZZY_BATCH_INLINE void vmin(V& a, const V& b) {
+  a = (b < a) ? b : a;
+}
+
+template <typename V>
+FUZZY_BATCH_INLINE void vmax(V& a, const V& b) {
+  a = (a < b) ? b : a;
+}
+
+// Branchless MembershipFunction::evaluate() into `mu`. The term type is uniform
+// across lanes; every piece is computed and the scalar branch order is
+// replayed with selects (unselected pieces may hold inf/NaN from degenerate
+// parameters).
+template <typename V>
+FUZZY_BATCH_INLINE void membership(MFType type, const std::array<double, 4>& p, const V& x,
+                                   V& mu) {
+  const V zero = {};
+  const V one = zero + 1.0;
+
+  switch (type) {
+  case MFType::TRIANGLE: {
+    double a = p[0], b = p[1], c = p[2];
+    V      r = (x < b) ? (x - a) / (b - a) : (c - x) / (c - b);
+    r = (x == b) ? one : r;
+    mu = (x <= a || x >= c) ? zero : r;
+    return;
+  }
+
+  case MFType::TRAPEZOID: {
+    double a = p[0], b = p[1], c = p[2], d = p[3];
+    V      r = (x < b) ? (x - a) / (b - a) : (d - x) / (d - c);
+    r = (x >= b && x <= c) ? one : r;
+    mu = (x <= a || x >= d) ? zero : r;
+    return;
+  }
+
+  case MFType::Z_SHAPE:
+  case MFType::S_SHAPE: {
+    double a = p[0], b = p[1];
+    V      t = (x - a) / (b - a);
+    if (type == MFType::Z_SHAPE) {
+      V r = (x >= b) ? zero : one - 2.0 * t * t;
+      mu = (x <= a) ? one : r;
+      return;
+    }
+    V r = (x >= b) ? one : 2.0 * t * t;
+    mu = (x <= a) ? zero : r;
+    return;
+  }
+  }
+  mu = zero;
+}
+
+// Degrees of every term of input v at the lanes of `x`, into
+// degrees[termBegin[v]...].
+template <typename V>
+FUZZY_BATCH_INLINE void fuzzifyLanes(const Layout& layout, size_t v, const V& x, V* degrees) {
+  constexpr size_t LANES = sizeof(V) / sizeof(double);
+
+  if (!layout.tables) {
+    for (uint32_t t = layout.termBegin[v]; t < layout.termBegin[v + 1]; ++t)
+      membership<V>(layout.type[t], layout.params[t], x, degrees[t]);
+    return;
+  }
+
+  // MembershipTable::fuzzify() across lanes: clamp and locate vectorized,
+  // gather each lane's two table rows, then apply the support mask.
+  const MembershipTable& table = layout.tables[v];
+  const size_t           terms = table.terms();
+  V                      low, high, tiny;
+  setAll(low, table.min());
+  setAll(high, table.max());
+  setAll(tiny, std::numeric_limits<double>::min());
+
+  V c = (x > low) ? x : low;
+  c = (c < high) ? c : high;
+  V pos = (c - low) * table.scale();
+
+  V      f;
+  size_t row[LANES];
+  for (size_t l = 0; l < LANES; ++l) {
+    size_t k = std::min(static_cast<size_t>(pos[l]), table.lastCell());
+    f[l] = pos[l] - static_cast<double>(k);
+    row[l] = k * terms;
+  }
+  for (size_t t = 0; t < terms; ++t) {
+    V a, b;
+    for (size_t l = 0; l < LANES; ++l) {
+      a[l] = table.values()[row[l] + t];
+      b[l] = table.values()[row[l] + terms + t];
+    }
+    V mu = a + f * (b - a);
+    vmax(mu, tiny);
+    degrees[layout.termBegin[v] + t] =
+        (x > table.supportFrom(t) && x < table.supportTo(t)) ? mu : V{};
+  }
+}
+
+// Evaluates samples [i, i + lanes) and writes their outputs.
+template <typename V>
+FUZZY_BATCH_INLINE void evaluateLanes(const Layout& layout, const double* const* columns, size_t i,
+                                      double* out) {
+  constexpr size_t LANES = sizeof(V) / sizeof(double);
+  const V          zero = {};
+
+  V degrees[MAX_INPUT_TERMS];
+  if (layout.termColumns) {
+    for (uint32_t t = 0; t < layout.termBegin[layout.numInputs]; ++t)
+      std::memcpy(&degrees[t], layout.termColumns[t] + i, sizeof(V));
+  } else {
+    for (size_t v = 0; v < layout.numInputs; ++v) {
+      V x;
+      std::memcpy(&x, columns[v] + i, sizeof(V));
+      fuzzifyLanes<V>(layout, v, x, degrees);
+    }
+  }
+
+  const size_t outputTerms = layout.output->mfs.size();
+  V            strengths[MAX_OUTPUT_TERMS];
+  for (size_t t = 0; t < outputTerms; ++t)
+    strengths[t] = zero;
+
+  for (size_t r = 0; r < layout.numRules; ++r) {
+    V strength = zero + 1.0;
+    for (uint32_t a = layout.ruleBegin[r]; a < layout.ruleBegin[r + 1]; ++a)
+      vmin(strength, degrees[layout.slots[a]]);
+
+    // The scalar engine skips rules at <= 0; clamping first keeps the sum equal.
+    V& term = strengths[layout.consequent[r]];
+    if (layout.sugeno) {
+      vmax(strength, zero);
+      term = term + strength;
+    } else {
+      vmax(term, strength);
+    }
+  }
+
+  if (layout.sugeno) {
+    V num = zero, den = zero;
+    for (size_t t = 0; t < outputTerms; ++t) {
+      auto fired = strengths[t] > 0.0;
+      num = fired ? num + strengths[t] * layout.sugenoConstants[t] : num;
+      den = fired ? den + strengths[t] : den;
+    }
+    V result = (den > 0.0) ? num / den : zero;
+    std::memcpy(out + i, &result, sizeof(V));
+    return;
+  }
+
+  if (!layout.gridX.empty()) {
+    // Sampled centroid across lanes; output memberships come from the grid table.
+    const size_t points = layout.gridX.size();
+    V            num = zero, den = zero;
+    for (size_t k = 0; k < points; ++k) {
+      V mu = zero;
+      for (size_t t = 0; t < outputTerms; ++t) {
+        V clipped;
+        setAll(clipped, layout.gridMu[t * points + k]);
+        vmin(clipped, strengths[t]);
+        vmax(mu, clipped);
+      }
+      num += layout.gridX[k] * mu;
+      den += mu;
+    }
+    V result = (den > 0.0) ? num / den : zero;
+    std::memcpy(out + i, &result, sizeof(V));
+    return;
+  }
+
+  // Closed-form centroid per lane.
+  for (size_t l = 0; l < LANES; ++l) {
+    double s[MAX_OUTPUT_TERMS];
+    for (size_t t = 0; t < outputTerms; ++t)
+      s[t] = strengths[t][l];
+    out[i + l] = layout.defuzzifier->centroid(*layout.output, s);
+  }
+}
+
+// Each returns how many leading samples it handled (a multiple of its width);
+// the caller finishes the tail with the scalar engine.
+FUZZY_BATCH_AVX2 inline size_t runAvx2(const Layout& layout, const double* const* columns,
+                                        size_t n, double* out) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    evaluateLanes<Vec4>(layout, columns, i, out);
+  return i;
+}
+
+FUZZY_BATCH_AVX512 inline size_t runAvx512(const Layout& layout, const double* const* columns,
+                                            size_t n, double* out) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    evaluateLanes<Vec8>(layout, columns, i, out);
+  return i;
+}
+
+// Writes the degrees of input v's terms for values [0, n) of `column` to
+// out[t] (term t counted within the input), a vector width at a time.
+template <typename V>
+FUZZY_BATCH_INLINE size_t fuzzifyColumn(const Layout& layout, size_t v, const double* column,
+                                        size_t n, double* const* out) {
+  constexpr size_t LANES = sizeof(V) / sizeof(double);
+
+  V            degrees[MAX_INPUT_TERMS];
+  const size_t first = layout.termBegin[v];
+  size_t       i = 0;
+  for (; i + LANES <= n; i += LANES) {
+    V x;
+    std::memcpy(&x, column + i, sizeof(V));
+    fuzzifyLanes<V>(layout, v, x, degrees);
+    for (uint32_t t = first; t < layout.termBegin[v + 1]; ++t)
+      std::memcpy(out[t - first] + i, &degrees[t], sizeof(V));
+  }
+  return i;
+}
+
+FUZZY_BATCH_AVX2 inline size_t fuzzifyAvx2(const Layout& layout, size_t v, const double* column,
+                                           size_t n, double* const* out) {
+  return fuzzifyColumn<Vec4>(layout, v, column, n, out);
+}
+
+FUZZY_BATCH_AVX512 inline size_t fuzzifyAvx512(const Layout& layout, size_t v,
+                                               const double* column, size_t n,
+                                               double* const* out) {
+  return fuzzifyColumn<Vec8>(layout, v, column, n, out);
+}
+
+#endif
+
+// Degrees of one input's terms over a column; returns how many leading values
+// were handled, like run().
+inline size_t fuzzify(Isa isa, const Layout& layout, size_t v, const double* column, size_t n,
+                      double* const* out) {
+#ifdef FUZZY_BATCH_SIMD
+  if (isa == Isa::AVX512)
+    return fuzzifyAvx512(layout, v, column, n, out);
+  if (isa == Isa::AVX2)
+    return fuzzifyAvx2(layout, v, column, n, out);
+#else
+  (void)isa;
+  (void)layout;
+  (void)v;
+  (void)column;
+  (void)n;
+  (void)out;
+#endif
+  return 0;
+}
+
+inline size_t run(Isa isa, const Layout& layout, const double* const* columns, size_t n,
+                  double* out) {
+#ifdef FUZZY_BATCH_SIMD
+  if (isa == Isa::AVX512)
+    return runAvx512(layout, columns, n, out);
+  if (isa == Isa::AVX2)
+    return runAvx2(layout, columns, n, out);
+#else
+  (void)isa;
+  (void)layout;
+  (void)columns;
+  (void)n;
+  (void)out;
+#endif
+  return 0;
+}
+} // namespace batch
+} // namespace fuzzy
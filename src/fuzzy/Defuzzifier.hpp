@@ -0,0 +1,258 @@
+#pragma once
+
+#include "FuzzyVariable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace fuzzy {
+
+// Upper bound on output terms; lets defuzzification work entirely on the stack.
+constexpr size_t MAX_OUTPUT_TERMS = 8;
+
+// Centroid of the Mamdani output set
+//
+//   A(x) = max(0, max_t min(mu_t(x), s_t))
+//
+// where s_t is the aggregated firing strength of output term t.
+//
+// EXACT integrates A and x*A in closed form. Every membership shape used here is
+// a polynomial of degree <= 2 between its parameters, so after splitting the
+// universe at the parameters, the clip points (mu_t = s_t), the pairwise
+// crossings of the clipped curves and their zeros, A is a single polynomial on
+// each piece.
+//
+// SAMPLED evaluates A at `resolution` evenly spaced points including both ends
+// of the universe. No per-point storage is used.
+class Defuzzifier {
+public:
+  enum class Method { EXACT, SAMPLED };
+
+  static Defuzzifier exact() { return Defuzzifier(Method::EXACT, 0); }
+
+  static Defuzzifier sampled(size_t resolution) {
+    if (resolution < 2)
+      throw std::runtime_error("Sampled defuzzification needs at least 2 points");
+    return Defuzzifier(Method::SAMPLED, resolution);
+  }
+
+  Defuzzifier() = default;
+
+  Method method() const { return method_; }
+  size_t resolution() const { return resolution_; }
+
+  // `strengths` holds one value per term of `output`. Returns 0 when nothing fires.
+  double centroid(const FuzzyVariable& output, const double* strengths) const {
+    return method_ == Method::EXACT ? exactCentroid(output, strengths)
+                                    : sampledCentroid(output, strengths);
+  }
+
+private:
+  // c0 + c1*u + c2*u^2
+  struct Poly {
+    double c0 = 0.0, c1 = 0.0, c2 = 0.0;
+
+    double operator()(double u) const { return c0 + u * (c1 + u * c2); }
+  };
+
+  static constexpr size_t MAX_BREAKS = 4 * MAX_OUTPUT_TERMS + 2;
+  static constexpr size_t MAX_CUTS = MAX_OUTPUT_TERMS * (MAX_OUTPUT_TERMS + 3) + 2;
+
+  Method method_ = Method::EXACT;
+  size_t resolution_ = 0;
+
+  Defuzzifier(Method method, size_t resolution) : method_(method), resolution_(resolution) {}
+
+  static double aggregate(const FuzzyVariable& output, const double* strengths, double x) {
+    double mu = 0.0;
+    for (size_t t = 0; t < output.mfs.size(); ++t)
+      mu = std::max(mu, std::min(output.mfs[t].evaluate(x), strengths[t]));
+    return mu;
+  }
+
+  double sampledCentroid(const FuzzyVariable& output, const double* strengths) const {
+    double step = (output.max - output.min) / static_cast<double>(resolution_ - 1);
+    double num = 0.0, den = 0.0;
+    for (size_t i = 0; i < resolution_; ++i) {
+      double x = output.min + static_cast<double>(i) * step;
+      double mu = aggregate(output, strengths, x);
+      num += x * mu;
+      den += mu;
+    }
+    return (den > 0.0) ? num / den : 0.0;
+  }
+
+  // Polynomial form of `mf` in u = x - origin, valid on an open interval around
+  // `x` that does not cross any of its parameters. Expanding around the left end
+  // of the interval rather than zero keeps small clip levels representable.
+  static Poly piece(const MembershipFunction& mf, double origin, double x) {
+    const auto& p = mf.p;
+    auto        ramp = [&](double from, double to) {
+      return Poly{(origin - from) / (to - from), 1.0 / (to - from), 0.0};
+    };
+
+    switch (mf.type) {
+    case MFType::TRIANGLE:
+      if (x <= p[0] || x >= p[2])
+        return {};
+      return (x < p[1]) ? ramp(p[0], p[1]) : ramp(p[2], p[1]);
+
+    case MFType::TRAPEZOID:
+      if (x <= p[0] || x >= p[3])
+        return {};
+      if (x >= p[1] && x <= p[2])
+        return {1.0, 0.0, 0.0};
+      return (x < p[1]) ? ramp(p[0], p[1]) : ramp(p[3], p[2]);
+
+    case MFType::Z_SHAPE:
+    case MFType::S_SHAPE: {
+      double a = p[0], b = p[1];
+      bool   z = mf.type == MFType::Z_SHAPE;
+      if (x <= a)
+        return {z ? 1.0 : 0.0, 0.0, 0.0};
+      if (x >= b)
+        return {z ? 0.0 : 1.0, 0.0, 0.0};
+      // 2t^2 with t = (x - a) / (b - a); Z is its complement.
+      double k = 2.0 / ((b - a) * (b - a)), d = origin - a;
+      Poly   s = {k * d * d, 2.0 * k * d, k};
+      return z ? Poly{1.0 - s.c0, -s.c1, -s.c2} : s;
+    }
+    }
+    return {};
+  }
+
+  // Appends the roots of `f` that lie strictly inside (lo, hi).
+  template <size_t N>
+  static void addRoots(const Poly& f, double lo, double hi, std::array<double, N>& cuts,
+                       size_t& count) {
+    auto add = [&](double r) {
+      if (r > lo && r < hi && count < N)
+        cuts[count++] = r;
+    };
+
+    if (f.c2 == 0.0) {
+      if (f.c1 != 0.0)
+        add(-f.c0 / f.c1);
+      return;
+    }
+
+    double disc = f.c1 * f.c1 - 4.0 * f.c2 * f.c0;
+    if (disc < 0.0)
+      return;
+    // Numerically stable pair: q = -(b + sign(b) sqrt(disc)) / 2.
+    double q = -0.5 * (f.c1 + std::copysign(std::sqrt(disc), f.c1));
+    if (q != 0.0) {
+      add(q / f.c2);
+      add(f.c0 / q);
+    } else {
+      add(0.0);
+    }
+  }
+
+  // Integrals of f and x*f over u in [lo, hi], where x = origin + u.
+  static void integrate(const Poly& f, double origin, double lo, double hi, double& num,
+                        double& den) {
+    auto area = [&](double u) { return u * (f.c0 + u * (f.c1 / 2.0 + u * f.c2 / 3.0)); };
+    auto moment = [&](double u) {
+      return u * u * (f.c0 / 2.0 + u * (f.c1 / 3.0 + u * f.c2 / 4.0));
+    };
+    double a = area(hi) - area(lo);
+    den += a;
+    num += origin * a + moment(hi) - moment(lo);
+  }
+
+  double exactCentroid(const FuzzyVariable& output, const double* strengths) const {
+    const size_t terms = output.mfs.size();
+    const double lo = output.min, hi = output.max;
+
+    std::array<double, MAX_BREAKS> breaks;
+    size_t                         numBreaks = 0;
+    breaks[numBreaks++] = lo;
+    breaks[numBreaks++] = hi;
+    for (size_t t = 0; t < terms; ++t) {
+      if (strengths[t] <= 0.0)
+        continue;
+      const auto& mf = output.mfs[t];
+      for (size_t k = 0; k < mf.paramCount(); ++k) {
+        if (mf.p[k] > lo && mf.p[k] < hi)
+          breaks[numBreaks++] = mf.p[k];
+      }
+    }
+    std::sort(breaks.begin(), breaks.begin() + numBreaks);
+
+    double num = 0.0, den = 0.0;
+    for (size_t b = 0; b + 1 < numBreaks; ++b) {
+      // Work in u = x - x0 on this piece.
+      double x0 = breaks[b], width = breaks[b + 1] - x0;
+      if (width <= 0.0)
+        continue;
+
+      // Raw membership polynomials on this piece, then where each meets its clip.
+      std::array<Poly, MAX_OUTPUT_TERMS> raw;
+      std::array<double, MAX_CUTS>       cuts;
+      size_t                             numCuts = 0;
+      cuts[numCuts++] = 0.0;
+      cuts[numCuts++] = width;
+      for (size_t t = 0; t < terms; ++t) {
+        if (strengths[t] <= 0.0)
+          continue;
+        raw[t] = piece(output.mfs[t], x0, x0 + 0.5 * width);
+        addRoots(Poly{raw[t].c0 - strengths[t], raw[t].c1, raw[t].c2}, 0.0, width, cuts,
+                 numCuts);
+      }
+      std::sort(cuts.begin(), cuts.begin() + numCuts);
+
+      for (size_t c = 0; c + 1 < numCuts; ++c) {
+        double u0 = cuts[c], u1 = cuts[c + 1];
+        if (u1 <= u0)
+          continue;
+
+        // Clipped curves are single polynomials here; split once more where
+        // they cross each other or zero, then take the upper envelope.
+        double                             mid = 0.5 * (u0 + u1);
+        std::array<Poly, MAX_OUTPUT_TERMS> clipped;
+        std::array<double, MAX_CUTS>       splits;
+        size_t                             numSplits = 0;
+        splits[numSplits++] = u0;
+        splits[numSplits++] = u1;
+        for (size_t t = 0; t < terms; ++t) {
+          if (strengths[t] <= 0.0)
+            continue;
+          clipped[t] = raw[t](mid) < strengths[t] ? raw[t] : Poly{strengths[t], 0.0, 0.0};
+          addRoots(clipped[t], u0, u1, splits, numSplits);
+          for (size_t o = 0; o < t; ++o) {
+            if (strengths[o] <= 0.0)
+              continue;
+            addRoots(Poly{clipped[t].c0 - clipped[o].c0, clipped[t].c1 - clipped[o].c1,
+                          clipped[t].c2 - clipped[o].c2},
+                     u0, u1, splits, numSplits);
+          }
+        }
+        std::sort(splits.begin(), splits.begin() + numSplits);
+
+        for (size_t s = 0; s + 1 < numSplits; ++s) {
+          double v0 = splits[s], v1 = splits[s + 1];
+          if (v1 <= v0)
+            continue;
+
+          double vm = 0.5 * (v0 + v1);
+          double best = 0.0;
+          size_t top = terms;
+          for (size_t t = 0; t < terms; ++t) {
+            if (strengths[t] > 0.0 && clipped[t](vm) > best) {
+              best = clipped[t](vm);
+              top = t;
+            }
+          }
+          if (top < terms)
+            integrate(clipped[top], x0, v0, v1, num, den);
+        }
+      }
+    }
+    return (den > 0.0) ? num / den : 0.0;
+  }
+};
+} // namespace fuzzy
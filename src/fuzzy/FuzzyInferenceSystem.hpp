@@ -1,64 +1,526 @@
 #pragma once
 
+#include "BatchInference.hpp"
+#include "Defuzzifier.hpp"
 #include "FuzzyRule.hpp"
 #include "FuzzyVariable.hpp"
+#include "MembershipTable.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace fuzzy {
 
+// MAMDANI clips each output term at the strongest rule concluding it and
+// defuzzifies the aggregated set. SUGENO (zero or first order Takagi-Sugeno)
+// gives every output term a crisp consequent and returns the firing-weighted
+// average of those values; no output universe is involved.
+enum class InferenceMode { MAMDANI, SUGENO };
+
+// Tracing policies for FuzzyInferenceSystem::evaluate(). The policy is a
+// template parameter and every hook sits behind `if constexpr (Trace::ENABLED)`,
+// so the NoTrace instantiation is the plain engine. Defining
+// FUZZY_NO_TRACE_HOOKS deletes the hooks from the source (RuleTrace then records
+// nothing); it exists only for the trace_codegen_check target, which requires
+// the NoTrace code to be identical with and without them.
+struct NoTrace {
+  static constexpr bool ENABLED = false;
+};
+
+// Records one evaluation into caller-owned buffers: ruleStrengths[r] for every
+// rule in addRule() order (<= 0 means it did not fire; evaluation of a rule
+// stops at its first zero antecedent), termStrengths[t] for every output term
+// after aggregation (max for Mamdani, sum for Sugeno), and the output.
+struct RuleTrace {
+  static constexpr bool ENABLED = true;
+
+  double* ruleStrengths = nullptr; // ruleCount() values
+  double* termStrengths = nullptr; // output terms
+  double  output = 0.0;
+};
+
+// Mamdani or Sugeno inference engine. The topology (variables, terms, rules) is built once;
+// membership parameters can then be overwritten in place with setParameters(),
+// which is how the GA re-targets one system to every chromosome. The evaluate
+// functions are const and keep no shared scratch state, so one instance can be
+// scored from any number of threads while nobody modifies it (see HotSwapModel).
 class FuzzyInferenceSystem {
 public:
-  void addInputVariable(const FuzzyVariable& var) { inputVars[var.name] = var; }
+  void addInputVariable(const FuzzyVariable& var) {
+    for (size_t i = 0; i < inputVars.size(); ++i) {
+      if (inputVars[i].name == var.name) {
+        inputVars[i] = var;
+        recompileRules();
+        return;
+      }
+    }
+    inputVars.push_back(var);
+    inputOrder.push_back(var.name);
+    recompileRules();
+  }
 
-  void setOutputVariable(const FuzzyVariable& var) { outputVar = var; }
+  void setOutputVariable(const FuzzyVariable& var) {
+    if (var.mfs.size() > MAX_OUTPUT_TERMS)
+      throw std::runtime_error("Too many terms in output variable: " + var.name);
+    outputVar = var;
+    recompileRules();
+    refreshSugenoConstants();
+  }
 
-  void addRule(const FuzzyRule& rule) { rules.push_back(rule); }
+  // Variables referenced by the rule must already be present.
+  void addRule(const FuzzyRule& rule) {
+    compileRule(rule);
+    rules.push_back(rule);
+  }
 
-  double evaluate(const std::map<std::string, double>& inputs) {
-    std::map<double, double> aggregated;
+  // Input variable names in the order they were added.
+  const std::vector<std::string>& inputNames() const { return inputOrder; }
 
-    for (const auto& rule : rules) {
-      double strength = 1.0;
+  // Number of membership parameters: every term of every input variable in
+  // insertion order, followed by the output variable's terms.
+  size_t parameterCount() const {
+    size_t count = 0;
+    for (const auto& var : inputVars) {
+      for (const auto& mf : var.mfs)
+        count += mf.paramCount();
+    }
+    for (const auto& mf : outputVar.mfs)
+      count += mf.paramCount();
+    return count;
+  }
+
+  // Overwrites all membership parameters from `params` (parameterCount() values,
+  // same order as parameterCount()). Only copies into the terms' inline
+  // parameter slots; the topology and rule base are left untouched.
+  void setParameters(const double* params) {
+    for (auto& var : inputVars) {
+      for (auto& mf : var.mfs) {
+        std::memcpy(mf.p.data(), params, mf.paramCount() * sizeof(double));
+        params += mf.paramCount();
+      }
+    }
+    for (auto& mf : outputVar.mfs) {
+      std::memcpy(mf.p.data(), params, mf.paramCount() * sizeof(double));
+      params += mf.paramCount();
+    }
+    refreshSugenoConstants();
+    tables.clear();
+  }
+
+  // Deployment option for a tuned, fixed parameter set: samples every input
+  // variable's terms into a MembershipTable of `resolution` points over the
+  // variable's [min, max], after which fuzzification is a table lookup with
+  // linear interpolation. Results then differ slightly from direct evaluation
+  // (see bench/lut_bench). setParameters() and any topology change discard the
+  // tables.
+  void freezeMembershipTables(size_t resolution) {
+    std::vector<MembershipTable> built;
+    for (const auto& var : inputVars)
+      built.emplace_back(var, resolution);
+    tables = std::move(built);
+  }
+
+  void clearMembershipTables() { tables.clear(); }
+
+  bool membershipTablesFrozen() const { return !tables.empty(); }
+
+  void setInferenceMode(InferenceMode m) { mode = m; }
+
+  InferenceMode getInferenceMode() const { return mode; }
+
+  // Sugeno consequent of output term `term`:
+  //
+  //   z = centre(term) + sum_i coefficients[i] * inputs[i]
+  //
+  // The constant is the mean of the term's membership parameters (a
+  // triangle's centroid, the middle of a Z/S transition where its degree
+  // crosses 0.5, the average of a trapezoid's corners), so every output
+  // parameter - and every GA gene that encodes one - moves a consequent.
+  // Coefficients follow inputNames() order; an empty list makes the term zero
+  // order (the default). The GA evolves zero-order consequents only.
+  void setSugenoCoefficients(const std::string& term, const std::vector<double>& coefficients) {
+    if (!coefficients.empty() && coefficients.size() != inputVars.size())
+      throw std::runtime_error("Sugeno coefficients must match the number of inputs");
+    size_t t = outputVar.termIndex(term);
+    for (size_t v = 0; v < inputVars.size(); ++v)
+      sugenoSlope[t * inputVars.size() + v] = coefficients.empty() ? 0.0 : coefficients[v];
+    sugenoLinear = std::any_of(sugenoSlope.begin(), sugenoSlope.end(),
+                               [](double a) { return a != 0.0; });
+  }
+
+  // Crisp consequent constant of output term t in Sugeno mode.
+  double sugenoConstant(size_t t) const { return sugenoConstants[t]; }
+
+  // Authoring/diagnostic form keyed by variable name.
+  double evaluate(const std::map<std::string, double>& inputs) const {
+    std::vector<double> x;
+    x.reserve(inputVars.size());
+    for (const auto& var : inputVars)
+      x.push_back(inputs.at(var.name));
+    return evaluate(x.data());
+  }
+
+  size_t ruleCount() const { return rules.size(); }
+
+  size_t outputTermCount() const { return outputVar.mfs.size(); }
+
+  size_t inputTermCount(size_t v) const { return inputVars[v].mfs.size(); }
+
+  // Membership parameters of input v: its slice of the setParameters() layout.
+  size_t inputParameterCount(size_t v) const {
+    size_t count = 0;
+    for (const auto& mf : inputVars[v].mfs)
+      count += mf.paramCount();
+    return count;
+  }
+
+  const std::vector<FuzzyRule>& getRules() const { return rules; }
+
+  // Positional form: inputs[i] is the value of the i-th variable in inputNames().
+  double evaluate(const double* inputs) const {
+    NoTrace trace;
+    return evaluate(inputs, trace);
+  }
+
+  // Same, reporting rule activity through a tracing policy (NoTrace/RuleTrace).
+  template <typename Trace>
+  double evaluate(const double* inputs, Trace& trace) const {
+    // Fuzzify every input once; rules then only read degrees[], so a term shared
+    // by several rules is evaluated a single time per sample.
+    std::array<double, MAX_INPUT_TERMS> degrees;
+    if (tables.empty()) {
+      for (size_t v = 0; v < inputVars.size(); ++v)
+        inputVars[v].fuzzify(inputs[v], degrees.data() + termOffset[v]);
+    } else {
+      for (size_t v = 0; v < inputVars.size(); ++v)
+        tables[v].fuzzify(inputs[v], degrees.data() + termOffset[v]);
+    }
+    return infer(inputs, degrees.data(), trace);
+  }
+
+  // Degrees of every term of input v for n values of that input: term t goes to
+  // out[t][0..n). Same values evaluate() computes, so a caller can keep them
+  // while the variable's parameters are unchanged and pass them back to the
+  // evaluateBatch() overload below.
+  void fuzzifyInput(size_t v, const double* column, size_t n, double* const* out) const {
+    static const batch::Isa isa = batch::detectIsa();
+    size_t                  done = 0;
+    if (isa != batch::Isa::SCALAR)
+      done = batch::fuzzify(isa, batchLayout(nullptr), v, column, n, out);
+
+    std::array<double, MAX_INPUT_TERMS> mu;
+    for (size_t i = done; i < n; ++i) {
+      if (tables.empty())
+        inputVars[v].fuzzify(column[i], mu.data());
+      else
+        tables[v].fuzzify(column[i], mu.data());
+      for (size_t t = 0; t < inputVars[v].mfs.size(); ++t)
+        out[t][i] = mu[t];
+    }
+  }
+
+  // Scores n samples given as one column per input (inputNames() order) and
+  // writes n outputs. Runs on the widest SIMD width the CPU supports; results are
+  // identical to calling evaluate() per sample.
+  void evaluateBatch(const double* const* columns, size_t n, double* out) const {
+    static const batch::Isa isa = batch::detectIsa();
+    evaluateBatch(columns, n, out, isa);
+  }
+
+  // Same, on an explicit instruction set (falls back to scalar for the tail). One
+  // the CPU lacks is narrowed to the widest it has rather than faulting.
+  // First-order Sugeno always runs scalar: how the slope dot product is fused
+  // differs between the scalar and vector code, which would break bit-identity.
+  void evaluateBatch(const double* const* columns, size_t n, double* out, batch::Isa isa) const {
+    evaluateBatch(columns, nullptr, n, out, isa);
+  }
+
+  // Same, with every term's degrees precomputed by fuzzifyInput(): one column of
+  // n values per term, inputs in inputNames() order and each input's terms in
+  // order. Only rule firing and defuzzification run; `columns` still supplies
+  // the inputs to first-order Sugeno consequents.
+  void evaluateBatch(const double* const* columns, const double* const* termColumns, size_t n,
+                     double* out) const {
+    static const batch::Isa isa = batch::detectIsa();
+    evaluateBatch(columns, termColumns, n, out, isa);
+  }
 
-      for (const auto& ant : rule.getAntecedents()) {
-        const auto& var = inputVars.at(ant.variable);
-        double      x = inputs.at(ant.variable);
+  void evaluateBatch(const double* const* columns, const double* const* termColumns, size_t n,
+                     double* out, batch::Isa isa) const {
+    static const batch::Isa supported = batch::detectIsa();
+    isa = std::min(isa, supported);
 
-        double mu = var.membership(ant.term, x);
+    size_t done = 0;
+    if (isa != batch::Isa::SCALAR && !(mode == InferenceMode::SUGENO && sugenoLinear)) {
+      batch::Layout layout = batchLayout(termColumns);
+      if (mode != InferenceMode::SUGENO)
+        layout.prepareGrid();
+      done = batch::run(isa, layout, columns, n, out);
+    }
 
-        strength = std::min(strength, mu);
+    // On the stack: Fitness calls this once per block per chromosome.
+    std::array<double, MAX_INPUT_TERMS> x; // recompileRules() bounds the input count
+    std::array<double, MAX_INPUT_TERMS> degrees;
+    NoTrace                             trace;
+    for (size_t i = done; i < n; ++i) {
+      for (size_t v = 0; v < inputVars.size(); ++v)
+        x[v] = columns[v][i];
+      if (!termColumns) {
+        out[i] = evaluate(x.data());
+        continue;
       }
+      for (size_t d = 0; d < degreeCount(); ++d)
+        degrees[d] = termColumns[d][i];
+      out[i] = infer(x.data(), degrees.data(), trace);
+    }
+  }
 
-      clipConsequent(rule.getConsequent(), strength, aggregated);
+  // Reorders every rule's antecedents by how often each term is non-zero on the
+  // given samples (columns in inputNames() order), using the current
+  // parameters. Without calibration the order comes from the share of each
+  // variable's universe a term covers. Only evaluation speed depends on it.
+  void calibrateRuleOrder(const double* const* columns, size_t n) {
+    if (n == 0)
+      return;
+
+    std::vector<double> degrees(degreeCount());
+    std::vector<size_t> active(degreeCount(), 0);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t v = 0; v < inputVars.size(); ++v)
+        inputVars[v].fuzzify(columns[v][i], degrees.data() + termOffset[v]);
+      for (size_t d = 0; d < degrees.size(); ++d)
+        active[d] += degrees[d] > 0.0;
     }
+    for (size_t d = 0; d < degrees.size(); ++d)
+      termActivity[d] = static_cast<double>(active[d]) / static_cast<double>(n);
 
-    return defuzzify(aggregated);
+    for (size_t r = 0; r < ruleConsequent.size(); ++r)
+      orderRule(r);
   }
 
+  // Exact closed-form centroid by default; Defuzzifier::sampled(n) evaluates the
+  // output set on an n-point grid instead.
+  void setDefuzzifier(const Defuzzifier& d) { defuzzifier = d; }
+
+  const Defuzzifier& getDefuzzifier() const { return defuzzifier; }
+
 private:
-  std::map<std::string, FuzzyVariable> inputVars;
-  FuzzyVariable                        outputVar;
-  std::vector<FuzzyRule>               rules;
+  // Rules are compiled into flat (variable index, term index) pairs when added,
+  // so inference never touches names.
+  struct CompiledAntecedent {
+    uint32_t variable;
+    uint32_t term;
+    uint32_t degree; // slot of (variable, term) in the per-sample degrees table
+  };
 
-  void clipConsequent(const Consequent& cons, double strength, std::map<double, double>& agg) {
-    for (double x = 0.0; x <= 1.0; x += 0.01) {
-      double mu = outputVar.membership(cons.term, x);
-      mu = std::min(mu, strength);
-      agg[x] = std::max(agg[x], mu);
+  std::vector<FuzzyVariable> inputVars;
+  std::vector<std::string>   inputOrder;
+  FuzzyVariable              outputVar;
+  std::vector<FuzzyRule>     rules;
+  Defuzzifier                defuzzifier;
+  InferenceMode              mode = InferenceMode::MAMDANI;
+
+  std::vector<MembershipTable> tables; // per input variable while frozen
+
+  std::array<double, MAX_OUTPUT_TERMS> sugenoConstants{};
+  std::vector<double>                  sugenoSlope;  // per output term, one per input
+  bool                                 sugenoLinear = false;
+
+  std::vector<uint32_t>           termOffset;
+  std::vector<CompiledAntecedent> antecedents;
+  std::vector<uint32_t>           antecedentSlots; // antecedents[i].degree, contiguous
+  std::vector<double>             termActivity;    // per slot: share of inputs with degree > 0
+  std::vector<uint32_t>           ruleBegin = {0};
+  std::vector<uint32_t>           ruleConsequent;
+
+  // Rule firing and defuzzification from a filled degrees table.
+  template <typename Trace>
+  double infer(const double* inputs, const double* degrees, Trace& trace) const {
+    // Firing strength per output term. Mamdani takes the max: clipping every
+    // rule's consequent at its own strength and taking the max is the same as
+    // clipping each term once at the strongest rule that concludes it. Sugeno
+    // sums, since rules sharing a consequent each carry their own weight.
+    std::array<double, MAX_OUTPUT_TERMS> strengths{};
+    const bool                           sugeno = mode == InferenceMode::SUGENO;
+
+    for (size_t r = 0; r + 1 < ruleBegin.size(); ++r) {
+      double strength = 1.0;
+
+      // Antecedents are stored most selective first, so a rule that does not
+      // fire usually stops after one lookup. A rule at <= 0 can never raise a
+      // term above its initial 0, so skipping it leaves the result unchanged.
+      for (uint32_t a = ruleBegin[r]; a < ruleBegin[r + 1] && strength > 0.0; ++a)
+        strength = std::min(strength, degrees[antecedentSlots[a]]);
+
+#ifndef FUZZY_NO_TRACE_HOOKS
+      if constexpr (Trace::ENABLED)
+        trace.ruleStrengths[r] = strength;
+#endif
+
+      if (strength <= 0.0)
+        continue;
+
+      double& term = strengths[ruleConsequent[r]];
+      term = sugeno ? term + strength : std::max(term, strength);
+    }
+
+    double output = sugeno ? sugenoOutput(inputs, strengths.data())
+                           : defuzzifier.centroid(outputVar, strengths.data());
+#ifndef FUZZY_NO_TRACE_HOOKS
+    if constexpr (Trace::ENABLED) {
+      std::copy(strengths.begin(), strengths.begin() + outputVar.mfs.size(),
+                trace.termStrengths);
+      trace.output = output;
     }
+#else
+    (void)trace;
+#endif
+    return output;
   }
 
-  double defuzzify(const std::map<double, double>& agg) {
-    double num = 0.0, den = 0.0;
-    for (const auto& [x, mu] : agg) {
-      num += x * mu;
-      den += mu;
+  // The model flattened for the batch kernels (see batch::Layout).
+  batch::Layout batchLayout(const double* const* termColumns) const {
+    batch::Layout layout;
+    layout.numInputs = inputVars.size();
+    for (size_t v = 0; v < inputVars.size(); ++v) {
+      layout.termBegin[v] = termOffset[v];
+      for (size_t t = 0; t < inputVars[v].mfs.size(); ++t) {
+        const auto& mf = inputVars[v].mfs[t];
+        layout.type[termOffset[v] + t] = mf.type;
+        layout.params[termOffset[v] + t] = mf.p;
+      }
+    }
+    layout.termBegin[inputVars.size()] = static_cast<uint32_t>(degreeCount());
+    layout.tables = tables.empty() ? nullptr : tables.data();
+    layout.termColumns = termColumns;
+    layout.numRules = ruleConsequent.size();
+    layout.ruleBegin = ruleBegin.data();
+    layout.slots = antecedentSlots.data();
+    layout.consequent = ruleConsequent.data();
+    layout.output = &outputVar;
+    layout.defuzzifier = &defuzzifier;
+    if (mode == InferenceMode::SUGENO) {
+      layout.sugeno = true;
+      layout.sugenoConstants = sugenoConstants.data();
+    }
+    return layout;
+  }
+
+  // Weighted average of the output terms' Sugeno consequents. Terms that did
+  // not fire are skipped so a zero weight never meets a non-finite slope term.
+  double sugenoOutput(const double* inputs, const double* strengths) const {
+    const size_t n = inputVars.size();
+    double       num = 0.0, den = 0.0;
+    for (size_t t = 0; t < outputVar.mfs.size(); ++t) {
+      if (strengths[t] <= 0.0)
+        continue;
+      double z = sugenoConstants[t];
+      if (sugenoLinear) {
+        for (size_t v = 0; v < n; ++v)
+          z += sugenoSlope[t * n + v] * inputs[v];
+      }
+      num += strengths[t] * z;
+      den += strengths[t];
     }
     return (den > 0.0) ? num / den : 0.0;
   }
+
+  static double centre(const MembershipFunction& mf) {
+    size_t count = mf.paramCount();
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i)
+      sum += mf.p[i];
+    return sum / static_cast<double>(count);
+  }
+
+  void refreshSugenoConstants() {
+    for (size_t t = 0; t < outputVar.mfs.size(); ++t)
+      sugenoConstants[t] = centre(outputVar.mfs[t]);
+  }
+
+  size_t degreeCount() const {
+    return inputVars.empty() ? 0 : termOffset.back() + inputVars.back().mfs.size();
+  }
+
+  size_t inputIndex(const std::string& name) const {
+    for (size_t i = 0; i < inputOrder.size(); ++i) {
+      if (inputOrder[i] == name)
+        return i;
+    }
+    throw std::runtime_error("Input variable not found: " + name);
+  }
+
+  void compileRule(const FuzzyRule& rule) {
+    for (const auto& ant : rule.getAntecedents()) {
+      size_t v = inputIndex(ant.variable);
+      size_t t = inputVars[v].termIndex(ant.term);
+      antecedents.push_back({static_cast<uint32_t>(v), static_cast<uint32_t>(t),
+                             static_cast<uint32_t>(termOffset[v] + t)});
+      antecedentSlots.push_back(antecedents.back().degree);
+    }
+    ruleBegin.push_back(static_cast<uint32_t>(antecedents.size()));
+    ruleConsequent.push_back(
+        static_cast<uint32_t>(outputVar.termIndex(rule.getConsequent().term)));
+    orderRule(ruleConsequent.size() - 1);
+  }
+
+  // Sorts rule r's antecedents by ascending termActivity (most selective first).
+  void orderRule(size_t r) {
+    auto first = antecedents.begin() + ruleBegin[r];
+    auto last = antecedents.begin() + ruleBegin[r + 1];
+    std::stable_sort(first, last, [&](const CompiledAntecedent& a, const CompiledAntecedent& b) {
+      return termActivity[a.degree] < termActivity[b.degree];
+    });
+    for (uint32_t a = ruleBegin[r]; a < ruleBegin[r + 1]; ++a)
+      antecedentSlots[a] = antecedents[a].degree;
+  }
+
+  // Share of the variable's universe where the term's degree is positive.
+  static double supportShare(const FuzzyVariable& var, const MembershipFunction& mf) {
+    if (!(var.max > var.min))
+      return 1.0;
+
+    double from, to;
+    positiveSupport(mf, from, to);
+    double covered = std::min(to, var.max) - std::max(from, var.min);
+    return std::max(0.0, covered) / (var.max - var.min);
+  }
+
+  // Variables may be replaced after rules were added; re-resolve all indices.
+  void recompileRules() {
+    termOffset.clear();
+    size_t terms = 0;
+    for (const auto& var : inputVars) {
+      termOffset.push_back(static_cast<uint32_t>(terms));
+      terms += var.mfs.size();
+    }
+    if (terms > MAX_INPUT_TERMS || inputVars.size() > MAX_INPUT_TERMS)
+      throw std::runtime_error("Too many input terms for the degrees table");
+
+    tables.clear();
+
+    // Topology changed: Sugeno consequents fall back to zero order.
+    sugenoSlope.assign(inputVars.size() * outputVar.mfs.size(), 0.0);
+    sugenoLinear = false;
+
+    termActivity.clear();
+    for (const auto& var : inputVars) {
+      for (const auto& mf : var.mfs)
+        termActivity.push_back(supportShare(var, mf));
+    }
+
+    antecedents.clear();
+    antecedentSlots.clear();
+    ruleBegin.assign(1, 0);
+    ruleConsequent.clear();
+    for (const auto& rule : rules)
+      compileRule(rule);
+  }
 };
 } // namespace fuzzy
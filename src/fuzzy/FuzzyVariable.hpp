@@ -2,6 +2,8 @@
 
 #include "MembershipFunction.hpp"
 
+#include <algorithm>
+#include <initializer_list>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -11,6 +13,21 @@ struct FuzzyVariable {
   double                          min;
   double                          max;
   std::vector<MembershipFunction> mfs;
+  std::vector<std::string>        labels; // side table, indexed by MembershipFunction::term
+
+  // Appends a term; `params` must hold exactly the shape's parameter count.
+  void addTerm(const std::string& label, MFType type, std::initializer_list<double> params) {
+    if (params.size() != membershipParamCount(type))
+      throw std::runtime_error("Wrong parameter count for term " + label + " in variable " + name);
+    MembershipFunction mf;
+    mf.type = type;
+    mf.term = static_cast<uint32_t>(labels.size());
+    std::copy(params.begin(), params.end(), mf.p.begin());
+    mfs.push_back(mf);
+    labels.push_back(label);
+  }
+
+  const std::string& label(size_t i) const { return labels[mfs[i].term]; }
 
   std::vector<double> fuzzify(double x) const {
     std::vector<double> mu;
@@ -21,12 +38,21 @@ struct FuzzyVariable {
     return mu;
   }
 
-  double membership(const std::string& label, double x) const {
-    for (const auto& mf : mfs) {
-      if (mf.label == label) {
-        return mf.evaluate(x);
-      }
+  // Writes the degree of every term, in term order, to `out` (mfs.size() values).
+  void fuzzify(double x, double* out) const {
+    for (size_t i = 0; i < mfs.size(); ++i)
+      out[i] = mfs[i].evaluate(x);
+  }
+
+  size_t termIndex(const std::string& label) const {
+    for (size_t i = 0; i < mfs.size(); ++i) {
+      if (this->label(i) == label)
+        return i;
     }
     throw std::runtime_error("Membership function not found: " + label + " in variable " + name);
   }
+
+  double membership(const std::string& label, double x) const {
+    return mfs[termIndex(label)].evaluate(x);
+  }
 };
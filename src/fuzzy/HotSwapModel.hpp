@@ -0,0 +1,165 @@
+#pragma once
+
+#include "FuzzyInferenceSystem.hpp"
+#include "ParameterFile.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace fuzzy {
+
+// A FuzzyInferenceSystem whose parameters can be replaced while scoring threads
+// keep running.
+//
+// The published model is immutable and sits behind an atomic pointer (RCU).
+// Each scoring thread owns a Reader; per call it announces the current epoch in
+// its own cache line, loads the pointer, evaluates and clears the slot again -
+// no locks and no shared reference counts on the scoring path. publish() builds
+// the next model off to the side, swaps the pointer and then waits until every
+// reader that might still see the old model has finished its call before
+// freeing it (epoch-based reclamation). Readers pick up the new model on their
+// next call; only publishers ever wait.
+class HotSwapModel {
+  struct Snapshot {
+    FuzzyInferenceSystem fis;
+    uint64_t             version;
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<bool>     claimed{false};
+    std::atomic<uint64_t> epoch{0}; // epoch at entry while inside a call, else 0
+  };
+
+public:
+  static constexpr size_t MAX_READERS = 64;
+
+  explicit HotSwapModel(FuzzyInferenceSystem model)
+      : current_(new Snapshot{std::move(model), 1}) {}
+
+  HotSwapModel(const HotSwapModel&) = delete;
+  HotSwapModel& operator=(const HotSwapModel&) = delete;
+
+  // All readers must have been destroyed.
+  ~HotSwapModel() { delete current_.load(); }
+
+  // Per-thread handle; not shareable between threads, movable.
+  class Reader {
+  public:
+    Reader(Reader&& other) noexcept : owner_(other.owner_), slot_(other.slot_) {
+      other.owner_ = nullptr;
+    }
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    Reader& operator=(Reader&&) = delete;
+
+    ~Reader() {
+      if (owner_)
+        owner_->slots_[slot_].claimed.store(false, std::memory_order_release);
+    }
+
+    double evaluate(const double* inputs) {
+      return read([&](const FuzzyInferenceSystem& fis) { return fis.evaluate(inputs); });
+    }
+
+    // The whole batch is scored with the model current when the call starts.
+    void evaluateBatch(const double* const* columns, size_t n, double* out) {
+      read([&](const FuzzyInferenceSystem& fis) {
+        fis.evaluateBatch(columns, n, out);
+        return 0.0;
+      });
+    }
+
+    // Version of the model used by the last call (1 = the initial model).
+    uint64_t version() const { return version_; }
+
+  private:
+    friend class HotSwapModel;
+
+    HotSwapModel* owner_;
+    size_t        slot_;
+    uint64_t      version_ = 0;
+
+    Reader(HotSwapModel* owner, size_t slot) : owner_(owner), slot_(slot) {}
+
+    template <typename Fn>
+    double read(Fn&& fn) {
+      Slot& slot = owner_->slots_[slot_];
+      // Both seq_cst: the slot must be visible before the pointer is read.
+      slot.epoch.store(owner_->epoch_.load());
+      const Snapshot* snapshot = owner_->current_.load();
+      version_ = snapshot->version;
+      double result = fn(snapshot->fis);
+      slot.epoch.store(0, std::memory_order_release);
+      return result;
+    }
+  };
+
+  // Claims a reader slot; throws when MAX_READERS are in use.
+  Reader reader() {
+    for (size_t s = 0; s < MAX_READERS; ++s) {
+      bool expected = false;
+      if (slots_[s].claimed.compare_exchange_strong(expected, true))
+        return Reader(this, s);
+    }
+    throw std::runtime_error("Too many concurrent HotSwapModel readers");
+  }
+
+  size_t parameterCount() const { return current_.load()->fis.parameterCount(); }
+
+  uint64_t version() const { return current_.load()->version; }
+
+  // Publishes the current model with new membership parameters
+  // (FuzzyInferenceSystem::setParameters() layout). Returns the new version.
+  uint64_t publish(const double* params) {
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    const Snapshot*             old = current_.load();
+    auto* next = new Snapshot{old->fis, old->version + 1};
+    next->fis.setParameters(params);
+    return swap(next);
+  }
+
+  // Publishes an arbitrary model (e.g. another topology or inference mode).
+  uint64_t publish(FuzzyInferenceSystem model) {
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    return swap(new Snapshot{std::move(model), current_.load()->version + 1});
+  }
+
+  // Loads an optimized_params.txt style file (see loadParameterFile) and
+  // publishes it. A malformed file throws and leaves the live model untouched.
+  uint64_t publishFile(const std::string& path) {
+    auto params = loadParameterFile(path, parameterCount());
+    return publish(params.data());
+  }
+
+private:
+  std::atomic<const Snapshot*> current_;
+  std::atomic<uint64_t>        epoch_{1};
+  std::array<Slot, MAX_READERS> slots_;
+  std::mutex                   publishMutex_; // serializes publishers only
+
+  // Caller holds publishMutex_.
+  uint64_t swap(const Snapshot* next) {
+    const Snapshot* old = current_.exchange(next);
+    uint64_t        epoch = epoch_.fetch_add(1) + 1;
+
+    // A reader that could have loaded `old` entered before the epoch moved on.
+    for (auto& slot : slots_) {
+      for (;;) {
+        uint64_t entered = slot.epoch.load();
+        if (entered == 0 || entered >= epoch)
+          break;
+        std::this_thread::yield();
+      }
+    }
+    delete old;
+    return next->version;
+  }
+};
+} // namespace fuzzy
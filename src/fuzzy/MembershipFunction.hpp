@@ -1,56 +1,109 @@
 #pragma once
 
-#include <algorithm>
-#include <string>
-#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 enum class MFType { TRIANGLE, TRAPEZOID, Z_SHAPE, S_SHAPE };
 
-struct MembershipFunction {
-  std::string         label;
-  MFType              type;
-  std::vector<double> p;
+// Membership degree of `x` for a term of the given shape with parameters `p`.
+// Shared by the dynamic engine (dispatching on the runtime type) and the
+// compile-time specialized one (type known statically).
+template <MFType Type>
+inline double evaluateMembership(const double* p, double x) {
+  if constexpr (Type == MFType::TRIANGLE) {
+    double a = p[0], b = p[1], c = p[2];
+    if (x <= a || x >= c)
+      return 0.0;
+    if (x == b)
+      return 1.0;
+    return (x < b) ? (x - a) / (b - a) : (c - x) / (c - b);
+  } else if constexpr (Type == MFType::TRAPEZOID) {
+    double a = p[0], b = p[1], c = p[2], d = p[3];
+    if (x <= a || x >= d)
+      return 0.0;
+    if (x >= b && x <= c)
+      return 1.0;
+    return (x < b) ? (x - a) / (b - a) : (d - x) / (d - c);
+  } else if constexpr (Type == MFType::Z_SHAPE) {
+    double a = p[0], b = p[1];
+    if (x <= a)
+      return 1.0;
+    if (x >= b)
+      return 0.0;
+    double t = (x - a) / (b - a);
+    return 1.0 - 2.0 * t * t;
+  } else {
+    double a = p[0], b = p[1];
+    if (x <= a)
+      return 0.0;
+    if (x >= b)
+      return 1.0;
+    double t = (x - a) / (b - a);
+    return 2.0 * t * t;
+  }
+}
 
-  double evaluate(double x) const {
-    switch (type) {
-    case MFType::TRIANGLE: {
-      double a = p[0], b = p[1], c = p[2];
-      if (x <= a || x >= c)
-        return 0.0;
-      if (x == b)
-        return 1.0;
-      return (x < b) ? (x - a) / (b - a) : (c - x) / (c - b);
-    }
+// Number of parameters of each shape.
+constexpr size_t membershipParamCount(MFType type) {
+  return type == MFType::TRAPEZOID ? 4 : type == MFType::TRIANGLE ? 3 : 2;
+}
 
-    case MFType::TRAPEZOID: {
-      double a = p[0], b = p[1], c = p[2], d = p[3];
-      if (x <= a || x >= d)
-        return 0.0;
-      if (x >= b && x <= c)
-        return 1.0;
-      return (x < b) ? (x - a) / (b - a) : (d - x) / (d - c);
-    }
+// Most parameters any shape takes.
+constexpr size_t MAX_MEMBERSHIP_PARAMS = 4;
 
-    case MFType::Z_SHAPE: {
-      double a = p[0], b = p[1];
-      if (x <= a)
-        return 1.0;
-      if (x >= b)
-        return 0.0;
-      double t = (x - a) / (b - a);
-      return 1.0 - 2.0 * t * t;
-    }
+// One term of a variable, held by value: shape, the term's id in the owning
+// variable's label table and its parameters inline (slots past paramCount()
+// are zero). Trivially copyable, so a variable's terms are one contiguous
+// block and parameters can be overwritten with memcpy.
+struct MembershipFunction {
+  MFType                                    type = MFType::TRIANGLE;
+  uint32_t                                  term = 0;
+  std::array<double, MAX_MEMBERSHIP_PARAMS> p{};
 
-    case MFType::S_SHAPE: {
-      double a = p[0], b = p[1];
-      if (x <= a)
-        return 0.0;
-      if (x >= b)
-        return 1.0;
-      double t = (x - a) / (b - a);
-      return 2.0 * t * t;
-    }
+  size_t paramCount() const { return membershipParamCount(type); }
+
+  double evaluate(double x) const {
+    switch (type) {
+    case MFType::TRIANGLE:
+      return evaluateMembership<MFType::TRIANGLE>(p.data(), x);
+    case MFType::TRAPEZOID:
+      return evaluateMembership<MFType::TRAPEZOID>(p.data(), x);
+    case MFType::Z_SHAPE:
+      return evaluateMembership<MFType::Z_SHAPE>(p.data(), x);
+    case MFType::S_SHAPE:
+      return evaluateMembership<MFType::S_SHAPE>(p.data(), x);
     }
     return 0.0;
   }
 };
+
+// Open interval (from, to) outside which the term's degree is <= 0; either end
+// may be infinite. Z shapes turn negative rather than zero past
+// a + (b - a) / sqrt(2), since 1 - 2t^2 < 0 there.
+inline void positiveSupport(const MembershipFunction& mf, double& from, double& to) {
+  const auto& p = mf.p;
+  from = -std::numeric_limits<double>::infinity();
+  to = std::numeric_limits<double>::infinity();
+  switch (mf.type) {
+  case MFType::TRIANGLE:
+    from = p[0];
+    to = p[2];
+    break;
+  case MFType::TRAPEZOID:
+    from = p[0];
+    to = p[3];
+    break;
+  case MFType::Z_SHAPE:
+    to = p[0] + (p[1] - p[0]) * 0.7071067811865476;
+    break;
+  case MFType::S_SHAPE:
+    from = p[0];
+    break;
+  }
+}
+
+static_assert(std::is_trivially_copyable<MembershipFunction>::value,
+              "MembershipFunction must stay trivially copyable");
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "FuzzyVariable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace fuzzy {
+
+// Every term of one variable sampled at `resolution` evenly spaced points over
+// [min, max] (both ends included), stored point-major so a lookup reads two
+// adjacent rows. Degrees are recovered by linear interpolation; inputs outside
+// the universe (and NaN) are clamped to it. Built from a snapshot of the
+// variable's parameters and never updated.
+//
+// Interpolation alone would blur where a term switches on: a cell straddling
+// the edge of a term's support yields small positive degrees outside it (or
+// <= 0 inside it), and a rule that fires at all moves the centroid to its
+// consequent however weak it is. So each degree is masked with the term's exact
+// positive support: 0 outside, and at least the smallest positive double inside.
+class MembershipTable {
+public:
+  MembershipTable(const FuzzyVariable& var, size_t resolution)
+      : min_(var.min), max_(var.max), terms_(var.mfs.size()), from_(terms_), to_(terms_) {
+    if (resolution < 2)
+      throw std::runtime_error("Membership table needs at least 2 points: " + var.name);
+    if (!(var.max > var.min))
+      throw std::runtime_error("Membership table needs a non-empty universe: " + var.name);
+
+    double step = (max_ - min_) / static_cast<double>(resolution - 1);
+    scale_ = 1.0 / step;
+    last_ = resolution - 2;
+    values_.resize(resolution * terms_);
+    for (size_t k = 0; k < resolution; ++k) {
+      double x = (k + 1 == resolution) ? max_ : min_ + static_cast<double>(k) * step;
+      var.fuzzify(x, values_.data() + k * terms_);
+    }
+    for (size_t t = 0; t < terms_; ++t)
+      positiveSupport(var.mfs[t], from_[t], to_[t]);
+  }
+
+  size_t terms() const { return terms_; }
+  size_t resolution() const { return last_ + 2; }
+
+  // Writes the interpolated degree of every term at `x` to `out`.
+  void fuzzify(double x, double* out) const {
+    size_t k;
+    double f = locate(x, k);
+    const double* lo = values_.data() + k * terms_;
+    const double* hi = lo + terms_;
+    for (size_t t = 0; t < terms_; ++t)
+      out[t] = mask(t, x, lo[t] + f * (hi[t] - lo[t]));
+  }
+
+  // Interpolated degree `mu` of term t at `x`, restricted to the term's support.
+  double mask(size_t t, double x, double mu) const {
+    return (x > from_[t] && x < to_[t]) ? std::max(mu, std::numeric_limits<double>::min()) : 0.0;
+  }
+
+  // Cell `k` holding `x` and the fraction of the way through it. Selects rather
+  // than branches; the batch kernels replay the same steps per lane.
+  double locate(double x, size_t& k) const {
+    double c = (x > min_) ? x : min_;
+    c = (c < max_) ? c : max_;
+    double pos = (c - min_) * scale_;
+    k = std::min(static_cast<size_t>(pos), last_);
+    return pos - static_cast<double>(k);
+  }
+
+  double min() const { return min_; }
+  double max() const { return max_; }
+  double supportFrom(size_t t) const { return from_[t]; }
+  double supportTo(size_t t) const { return to_[t]; }
+  double scale() const { return scale_; }
+  size_t lastCell() const { return last_; }
+
+  const double* values() const { return values_.data(); }
+
+private:
+  double              min_;
+  double              max_;
+  double              scale_ = 0.0;
+  size_t              terms_;
+  size_t              last_ = 0; // index of the last cell, resolution - 2
+  std::vector<double> values_;   // values_[k * terms_ + t]: term t at point k
+  std::vector<double> from_;     // per term: open interval of positive degree
+  std::vector<double> to_;
+};
+} // namespace fuzzy
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fuzzy {
+
+// Reads a parameter file as written by the optimizer (results/optimized_params.txt):
+// '#' starts a comment running to the end of the line, and the parameters are the
+// remaining numbers separated by commas and/or whitespace, in setParameters() order.
+// Throws if the file cannot be read, a token is not a number, or the count differs
+// from `expectedCount` (when non-zero).
+inline std::vector<double> loadParameterFile(const std::string& path, size_t expectedCount = 0) {
+  std::ifstream in(path);
+  if (!in.is_open())
+    throw std::runtime_error("Cannot open parameter file: " + path);
+
+  std::vector<double> params;
+  std::string         line;
+  size_t              lineNo = 0;
+  while (std::getline(in, line)) {
+    ++lineNo;
+    line = line.substr(0, line.find('#'));
+    for (char& c : line) {
+      if (c == ',')
+        c = ' ';
+    }
+
+    std::istringstream tokens(line);
+    std::string        token;
+    while (tokens >> token) {
+      size_t used = 0;
+      double value = 0.0;
+      try {
+        value = std::stod(token, &used);
+      } catch (const std::exception&) {
+        used = 0;
+      }
+      if (used != token.size())
+        throw std::runtime_error("Invalid parameter '" + token + "' at " + path + ":" +
+                                 std::to_string(lineNo));
+      params.push_back(value);
+    }
+  }
+
+  if (expectedCount != 0 && params.size() != expectedCount)
+    throw std::runtime_error("Parameter file " + path + " has " + std::to_string(params.size()) +
+                             " values, expected " + std::to_string(expectedCount));
+  return params;
+}
+} // namespace fuzzy
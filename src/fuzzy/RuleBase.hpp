@@ -2,71 +2,93 @@
 
 #include "FuzzyRule.hpp"
 
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace fuzzy {
 
-inline std::vector<FuzzyRule> normalBehaviorRules() {
-  return {
-
-      FuzzyRule({{"SpeedChange", "Zero"},
-                 {"HeadingChange", "Zero"},
-                 {"VerticalRateChange", "Zero"},
-                 {"TimeGap", "Small"}},
-                {"AnomalyLevel", "Low"}),
-
-      FuzzyRule({{"SpeedChange", "Negative"}, {"HeadingChange", "Zero"}, {"TimeGap", "Small"}},
-                {"AnomalyLevel", "Low"}),
-
-      FuzzyRule(
-          {{"SpeedChange", "Positive"}, {"VerticalRateChange", "Positive"}, {"TimeGap", "Small"}},
-          {"AnomalyLevel", "Low"})};
-}
-
-inline std::vector<FuzzyRule> strongAnomalyRules() {
-  return {
-
-      FuzzyRule({{"SpeedChange", "Positive_Large"},
-                 {"HeadingChange", "Positive_Large"},
-                 {"TimeGap", "Small"}},
-                {"AnomalyLevel", "High"}),
-
-      FuzzyRule({{"HeadingChange", "Positive"},
-                 {"VerticalRateChange", "Negative_Large"},
-                 {"TimeGap", "Small"}},
-                {"AnomalyLevel", "High"}),
-
-      FuzzyRule({{"AltitudeChange", "Positive_Large"},
-                 {"VerticalRateChange", "Zero"},
-                 {"TimeGap", "Small"}},
-                {"AnomalyLevel", "High"})};
+// Variable and term of one antecedent or consequent, by name.
+struct RuleTermName {
+  std::string_view variable;
+  std::string_view term;
+};
+
+// One rule as constexpr data: up to four antecedents (unused ones have an empty
+// variable) and the consequent. The ADS-B table below is the only copy of the
+// rule base; createAdsbRuleBase() builds FuzzyRules from it and AdsbTopology
+// derives its compile-time rule table from it.
+struct RuleSpec {
+  std::array<RuleTermName, 4> antecedents;
+  RuleTermName                consequent;
+};
+
+inline constexpr std::array<RuleSpec, 11> ADSB_RULES = {{
+    // Normal behavior.
+    {{{{"SpeedChange", "Zero"},
+       {"HeadingChange", "Zero"},
+       {"VerticalRateChange", "Zero"},
+       {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "Low"}},
+    {{{{"SpeedChange", "Negative"}, {"HeadingChange", "Zero"}, {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "Low"}},
+    {{{{"SpeedChange", "Positive"}, {"VerticalRateChange", "Positive"}, {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "Low"}},
+
+    // Strong anomalies.
+    {{{{"SpeedChange", "Positive_Large"},
+       {"HeadingChange", "Positive_Large"},
+       {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "High"}},
+    {{{{"HeadingChange", "Positive"},
+       {"VerticalRateChange", "Negative_Large"},
+       {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "High"}},
+    {{{{"AltitudeChange", "Positive_Large"},
+       {"VerticalRateChange", "Zero"},
+       {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "High"}},
+
+    // Large time gaps.
+    {{{{"TimeGap", "Large"}, {"SpeedChange", "Positive_Large"}}}, {"AnomalyLevel", "Medium"}},
+    {{{{"TimeGap", "Large"}, {"HeadingChange", "Positive_Large"}}}, {"AnomalyLevel", "Low"}},
+    {{{{"TimeGap", "Large"}, {"SpeedChange", "Zero"}}}, {"AnomalyLevel", "Low"}},
+
+    // Compound anomalies.
+    {{{{"SpeedChange", "Positive"},
+       {"HeadingChange", "Negative"},
+       {"VerticalRateChange", "Positive_Large"},
+       {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "High"}},
+    {{{{"SpeedChange", "Negative"}, {"AltitudeChange", "Positive_Large"}, {"TimeGap", "Small"}}},
+     {"AnomalyLevel", "High"}},
+}};
+
+// FuzzyRules for ADSB_RULES[first, first + count).
+inline std::vector<FuzzyRule> adsbRules(size_t first, size_t count) {
+  std::vector<FuzzyRule> rules;
+  for (size_t r = first; r < first + count; ++r) {
+    const RuleSpec&         spec = ADSB_RULES[r];
+    std::vector<Antecedent> antecedents;
+    for (const RuleTermName& a : spec.antecedents) {
+      if (!a.variable.empty())
+        antecedents.push_back({std::string(a.variable), std::string(a.term)});
+    }
+    rules.emplace_back(std::move(antecedents), Consequent{std::string(spec.consequent.variable),
+                                                          std::string(spec.consequent.term)});
+  }
+  return rules;
 }
 
-inline std::vector<FuzzyRule> timeGapRules() {
-  return {
+inline std::vector<FuzzyRule> normalBehaviorRules() { return adsbRules(0, 3); }
 
-      FuzzyRule({{"TimeGap", "Large"}, {"SpeedChange", "Positive_Large"}},
-                {"AnomalyLevel", "Medium"}),
+inline std::vector<FuzzyRule> strongAnomalyRules() { return adsbRules(3, 3); }
 
-      FuzzyRule({{"TimeGap", "Large"}, {"HeadingChange", "Positive_Large"}},
-                {"AnomalyLevel", "Low"}),
-
-      FuzzyRule({{"TimeGap", "Large"}, {"SpeedChange", "Zero"}}, {"AnomalyLevel", "Low"})};
-}
+inline std::vector<FuzzyRule> timeGapRules() { return adsbRules(6, 3); }
 
-inline std::vector<FuzzyRule> compoundAnomalyRules() {
-  return {
-
-      FuzzyRule({{"SpeedChange", "Positive"},
-                 {"HeadingChange", "Negative"},
-                 {"VerticalRateChange", "Positive_Large"},
-                 {"TimeGap", "Small"}},
-                {"AnomalyLevel", "High"}),
-
-      FuzzyRule(
-          {{"SpeedChange", "Negative"}, {"AltitudeChange", "Positive_Large"}, {"TimeGap", "Small"}},
-          {"AnomalyLevel", "High"})};
-}
+inline std::vector<FuzzyRule> compoundAnomalyRules() { return adsbRules(9, 2); }
 
 inline std::vector<FuzzyRule> createAdsbRuleBase() {
   std::vector<FuzzyRule> rules;
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "Defuzzifier.hpp"
+#include "FuzzyVariable.hpp"
+#include "MembershipFunction.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace fuzzy {
+
+// Marks an input a static rule does not test.
+constexpr int NO_TERM = -1;
+
+// One rule of a compile-time rule table: the term tested on each input (or
+// NO_TERM) and the output term it concludes.
+template <size_t Inputs>
+struct StaticRule {
+  std::array<int, Inputs> terms;
+  int                     consequent;
+};
+
+// Total parameter count of a list of term shapes.
+template <size_t N>
+constexpr size_t membershipParamCount(const std::array<MFType, N>& types) {
+  size_t count = 0;
+  for (MFType type : types)
+    count += membershipParamCount(type);
+  return count;
+}
+
+// Mamdani engine whose topology is a compile-time parameter. `Topology` provides
+//
+//   static constexpr std::array<size_t, I>       TERM_COUNTS;   terms per input
+//   static constexpr std::array<MFType, T>       INPUT_TYPES;   all input terms, in order
+//   static constexpr std::array<MFType, O>       OUTPUT_TYPES;
+//   static constexpr std::array<StaticRule<I>, R> RULES;
+//   static std::vector<FuzzyVariable> inputVariables();  default input terms
+//   static FuzzyVariable outputVariable();       universe and default output terms
+//
+// Term shapes, parameter offsets and the rule table are constants, so
+// fuzzification and rule firing unroll completely and membership parameters sit
+// in a flat array the compiler can keep in registers. Parameter layout and
+// results match FuzzyInferenceSystem built from the same variables and rules.
+template <typename Topology>
+class StaticFuzzySystem {
+public:
+  static constexpr size_t INPUTS = Topology::TERM_COUNTS.size();
+  static constexpr size_t INPUT_TERMS = Topology::INPUT_TYPES.size();
+  static constexpr size_t OUTPUT_TERMS = Topology::OUTPUT_TYPES.size();
+  static constexpr size_t RULES = Topology::RULES.size();
+  static constexpr size_t INPUT_PARAMS = membershipParamCount(Topology::INPUT_TYPES);
+  static constexpr size_t OUTPUT_PARAMS = membershipParamCount(Topology::OUTPUT_TYPES);
+
+  static_assert(OUTPUT_TERMS <= MAX_OUTPUT_TERMS, "Too many output terms");
+
+  // Starts from the topology's default parameters; the variables' shapes are
+  // checked against the compile-time layout.
+  StaticFuzzySystem() : output_(Topology::outputVariable()) {
+    auto   inputs = Topology::inputVariables();
+    size_t term = 0, offset = 0;
+    bool   ok = inputs.size() == INPUTS && output_.mfs.size() == OUTPUT_TERMS;
+    for (size_t v = 0; ok && v < INPUTS; ++v) {
+      ok = inputs[v].mfs.size() == Topology::TERM_COUNTS[v];
+      for (size_t t = 0; ok && t < inputs[v].mfs.size(); ++t, ++term) {
+        const auto& mf = inputs[v].mfs[t];
+        ok = mf.type == Topology::INPUT_TYPES[term];
+        if (ok) {
+          std::copy_n(mf.p.begin(), mf.paramCount(), params_.begin() + offset);
+          offset += mf.paramCount();
+        }
+      }
+    }
+    offset = 0;
+    for (size_t t = 0; ok && t < OUTPUT_TERMS; ++t) {
+      const auto& mf = output_.mfs[t];
+      ok = mf.type == Topology::OUTPUT_TYPES[t];
+      if (ok) {
+        std::copy_n(mf.p.begin(), mf.paramCount(), outputParams_.begin() + offset);
+        offset += mf.paramCount();
+      }
+    }
+    if (!ok)
+      throw std::runtime_error("Fuzzy variables do not match the static topology");
+  }
+
+  static constexpr size_t parameterCount() { return INPUT_PARAMS + OUTPUT_PARAMS; }
+
+  // Same layout as FuzzyInferenceSystem::setParameters(): input terms in order,
+  // then output terms.
+  void setParameters(const double* params) {
+    std::copy(params, params + INPUT_PARAMS, params_.begin());
+    params += INPUT_PARAMS;
+    std::copy(params, params + OUTPUT_PARAMS, outputParams_.begin());
+    for (auto& mf : output_.mfs) {
+      std::memcpy(mf.p.data(), params, mf.paramCount() * sizeof(double));
+      params += mf.paramCount();
+    }
+  }
+
+  void setDefuzzifier(const Defuzzifier& d) { defuzzifier_ = d; }
+
+  // inputs[i] is the value of input i in topology order.
+  double evaluate(const double* inputs) const {
+    std::array<double, INPUT_TERMS> degrees;
+    fuzzify(inputs, degrees, std::make_index_sequence<INPUT_TERMS>{});
+
+    std::array<double, MAX_OUTPUT_TERMS> strengths{};
+    fire(degrees, strengths, std::make_index_sequence<RULES>{});
+
+    if (defuzzifier_.method() == Defuzzifier::Method::SAMPLED)
+      return sampledCentroid(strengths, std::make_index_sequence<OUTPUT_TERMS>{});
+    return defuzzifier_.centroid(output_, strengths.data());
+  }
+
+private:
+  std::array<double, INPUT_PARAMS>  params_{};
+  std::array<double, OUTPUT_PARAMS> outputParams_{};
+  FuzzyVariable                     output_; // same parameters, for the exact centroid
+  Defuzzifier                       defuzzifier_;
+
+  static constexpr size_t paramOffset(size_t term) {
+    size_t offset = 0;
+    for (size_t t = 0; t < term; ++t)
+      offset += membershipParamCount(Topology::INPUT_TYPES[t]);
+    return offset;
+  }
+
+  static constexpr size_t outputParamOffset(size_t term) {
+    size_t offset = 0;
+    for (size_t t = 0; t < term; ++t)
+      offset += membershipParamCount(Topology::OUTPUT_TYPES[t]);
+    return offset;
+  }
+
+  // Input feeding flattened term `term`.
+  static constexpr size_t inputOf(size_t term) {
+    size_t input = 0;
+    for (size_t end = Topology::TERM_COUNTS[0]; term >= end; end += Topology::TERM_COUNTS[input])
+      ++input;
+    return input;
+  }
+
+  // First flattened term of `input`.
+  static constexpr size_t termBase(size_t input) {
+    size_t base = 0;
+    for (size_t i = 0; i < input; ++i)
+      base += Topology::TERM_COUNTS[i];
+    return base;
+  }
+
+  template <size_t... T>
+  void fuzzify(const double* inputs, std::array<double, INPUT_TERMS>& degrees,
+               std::index_sequence<T...>) const {
+    ((degrees[T] = evaluateMembership<Topology::INPUT_TYPES[T]>(params_.data() + paramOffset(T),
+                                                                 inputs[inputOf(T)])),
+     ...);
+  }
+
+  template <size_t R, size_t... I>
+  static double ruleStrength(const std::array<double, INPUT_TERMS>& degrees,
+                             std::index_sequence<I...>) {
+    double strength = 1.0;
+    ((strength = Topology::RULES[R].terms[I] == NO_TERM
+                     ? strength
+                     : std::min(strength, degrees[termBase(I) + Topology::RULES[R].terms[I]])),
+     ...);
+    return strength;
+  }
+
+  template <size_t... R>
+  static void fire(const std::array<double, INPUT_TERMS>&  degrees,
+                   std::array<double, MAX_OUTPUT_TERMS>& strengths, std::index_sequence<R...>) {
+    ((strengths[Topology::RULES[R].consequent] =
+          std::max(strengths[Topology::RULES[R].consequent],
+                   ruleStrength<R>(degrees, std::make_index_sequence<INPUTS>{}))),
+     ...);
+  }
+
+  // Defuzzifier's sampled centroid with the output shapes resolved statically.
+  template <size_t... T>
+  double sampledCentroid(const std::array<double, MAX_OUTPUT_TERMS>& strengths,
+                         std::index_sequence<T...>) const {
+    size_t points = defuzzifier_.resolution();
+    double step = (output_.max - output_.min) / static_cast<double>(points - 1);
+    double num = 0.0, den = 0.0;
+    for (size_t i = 0; i < points; ++i) {
+      double x = output_.min + static_cast<double>(i) * step;
+      double mu = 0.0;
+      ((mu = std::max(mu, std::min(evaluateMembership<Topology::OUTPUT_TYPES[T]>(
+                                       outputParams_.data() + outputParamOffset(T), x),
+                                   strengths[T]))),
+       ...);
+      num += x * mu;
+      den += mu;
+    }
+    return (den > 0.0) ? num / den : 0.0;
+  }
+};
+} // namespace fuzzy
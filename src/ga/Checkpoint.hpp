@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <unistd.h>
+
+namespace ga {
+
+// A GA checkpoint is a flat sequence of fixed-size values in host byte order,
+// written and read back in the same order by GAEngine and Population, after a
+// header of magic and version. It is only meant to be resumed by the same
+// build on the same architecture.
+constexpr char     CHECKPOINT_MAGIC[8] = {'A', 'D', 'S', 'B', 'G', 'A', 'C', '\0'};
+constexpr uint32_t CHECKPOINT_VERSION = 3;
+
+// Writes to a temporary file that commit() flushes to disk and renames over
+// `path`, so a crash at any point leaves the previous checkpoint intact.
+class CheckpointWriter {
+public:
+  explicit CheckpointWriter(const std::string& path)
+      : path_(path), tmpPath_(path + ".tmp." + std::to_string(::getpid())) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+      std::filesystem::create_directories(parent);
+
+    file_ = std::fopen(tmpPath_.c_str(), "wb");
+    if (!file_)
+      throw std::runtime_error("Failed to create checkpoint: " + tmpPath_);
+    putArray(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    put(CHECKPOINT_VERSION);
+  }
+
+  ~CheckpointWriter() {
+    if (file_) {
+      std::fclose(file_);
+      std::remove(tmpPath_.c_str());
+    }
+  }
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  template <typename T> void put(const T& value) { putArray(&value, 1); }
+
+  template <typename T> void putArray(const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be plain data");
+    ok_ = ok_ && std::fwrite(values, sizeof(T), count, file_) == count;
+  }
+
+  void commit() {
+    bool ok = ok_ && std::fflush(file_) == 0 && ::fsync(::fileno(file_)) == 0;
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    if (!ok || std::rename(tmpPath_.c_str(), path_.c_str()) != 0) {
+      std::remove(tmpPath_.c_str());
+      throw std::runtime_error("Failed to write checkpoint: " + path_);
+    }
+  }
+
+private:
+  std::string path_;
+  std::string tmpPath_;
+  FILE*       file_ = nullptr;
+  bool        ok_ = true;
+};
+
+// Reads a checkpoint back; throws std::runtime_error if the file is missing,
+// foreign or shorter than what is asked of it.
+class CheckpointReader {
+public:
+  explicit CheckpointReader(const std::string& path) : path_(path) {
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_)
+      throw std::runtime_error("Failed to open checkpoint: " + path);
+
+    char     magic[sizeof(CHECKPOINT_MAGIC)] = {};
+    uint32_t version = 0;
+    bool     read = std::fread(magic, 1, sizeof(magic), file_) == sizeof(magic) &&
+                std::fread(&version, sizeof(version), 1, file_) == 1;
+    if (!read || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        version != CHECKPOINT_VERSION) {
+      std::fclose(file_);
+      throw std::runtime_error("Not a checkpoint of this version: " + path);
+    }
+  }
+
+  ~CheckpointReader() { std::fclose(file_); }
+
+  CheckpointReader(const CheckpointReader&) = delete;
+  CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+  template <typename T> T get() {
+    T value;
+    getArray(&value, 1);
+    return value;
+  }
+
+  template <typename T> void getArray(T* values, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be plain data");
+    if (std::fread(values, sizeof(T), count, file_) != count)
+      throw std::runtime_error("Checkpoint is truncated: " + path_);
+  }
+
+  // For callers that find the contents do not fit the run being resumed.
+  [[noreturn]] void mismatch(const std::string& what) const {
+    throw std::runtime_error("Checkpoint " + path_ + " does not match this run: " + what);
+  }
+
+private:
+  std::string path_;
+  FILE*       file_ = nullptr;
+};
+} // namespace ga
@@ -65,6 +65,14 @@ const std::vector<double> Chromosome::DEFAULT_GENES = {
 };
 #endif
 
+uint64_t hashGenes(const double* genes, size_t count) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(genes);
+  uint64_t    hash = 14695981039346656037ull;
+  for (size_t i = 0; i < count * sizeof(double); ++i)
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  return hash;
+}
+
 Chromosome::Chromosome() {
 #ifdef GA_TEST_MODE
   if (DEFAULT_GENES.size() != 6)
@@ -80,9 +88,16 @@ Chromosome::Chromosome() {
   repair();
 }
 
-void Chromosome::updateBounds() {
+void Chromosome::updateBounds() { updateRowBounds(genes.data(), bounds.data()); }
+
+void Chromosome::repair() {
+  scored = false;
+  repairRow(genes.data(), bounds.data());
+}
+
+void updateRowBounds(const double* genes, GeneBounds* bounds) {
 #ifdef GA_TEST_MODE
-  for (size_t i = 0; i < genes.size(); ++i) {
+  for (size_t i = 0; i < TOTAL_GENES; ++i) {
     bounds[i].min = 0.0;
     bounds[i].max = 10.0;
   }
@@ -103,7 +118,7 @@ void Chromosome::updateBounds() {
     return 5;
   };
 
-  for (size_t i = 0; i < genes.size(); ++i) {
+  for (size_t i = 0; i < TOTAL_GENES; ++i) {
     size_t offset;
     size_t var_idx = getVarIndexAndOffset(i, offset);
 
@@ -228,12 +243,8 @@ void Chromosome::updateBounds() {
 #endif
 }
 
-void Chromosome::repair() {
-  assert(!genes.empty());
-
-  for (size_t i = 0; i < genes.size(); ++i) {
-    assert(i < bounds.size());
-
+void repairRow(double* genes, const GeneBounds* bounds) {
+  for (size_t i = 0; i < TOTAL_GENES; ++i) {
     if (genes[i] < bounds[i].min)
       genes[i] = bounds[i].min;
     if (genes[i] > bounds[i].max)
@@ -244,31 +255,41 @@ void Chromosome::repair() {
   }
 }
 
-void Chromosome::mutate(double mutationRate) {
-  static std::random_device              rd;
-  static std::mt19937                    gen(rd());
+void mutateRow(double* genes, const GeneBounds* bounds, double mutationRate, Rng& rng) {
   std::uniform_real_distribution<double> prob(0.0, 1.0);
 
-  for (size_t i = 0; i < genes.size(); ++i) {
-    if (prob(gen) < mutationRate) {
-      double                                 range = bounds[i].max - bounds[i].min;
+  for (size_t i = 0; i < TOTAL_GENES; ++i) {
+    if (prob(rng) < mutationRate) {
       std::uniform_real_distribution<double> geneDist(bounds[i].min, bounds[i].max);
-      genes[i] = geneDist(gen);
+      genes[i] = geneDist(rng);
     }
   }
 }
 
-std::pair<Chromosome, Chromosome> Chromosome::crossoverTwo(const Chromosome& other,
-                                                           std::mt19937&     rng) const {
-  Chromosome child1 = *this;
-  Chromosome child2 = other;
+void gaussianMutateRow(double* genes, const GeneBounds* bounds, double mutationRate, double step,
+                       Rng& rng) {
+  std::uniform_real_distribution<double> prob(0.0, 1.0);
+  std::normal_distribution<double>       normal(0.0, 1.0);
+
+  for (size_t i = 0; i < TOTAL_GENES; ++i) {
+    if (prob(rng) < mutationRate) {
+      double gene = genes[i] + normal(rng) * step * (bounds[i].max - bounds[i].min);
+      if (gene < bounds[i].min)
+        gene = bounds[i].min;
+      if (gene > bounds[i].max)
+        gene = bounds[i].max;
+      genes[i] = gene;
+    }
+  }
+}
 
+void crossoverRows(double* a, double* b, Rng& rng) {
 #ifdef GA_TEST_MODE
-  std::uniform_int_distribution<size_t> dist(1, genes.size() - 1);
+  std::uniform_int_distribution<size_t> dist(1, TOTAL_GENES - 1);
   size_t                                crossPoint = dist(rng);
 
-  for (size_t i = crossPoint; i < genes.size(); ++i) {
-    std::swap(child1.genes[i], child2.genes[i]);
+  for (size_t i = crossPoint; i < TOTAL_GENES; ++i) {
+    std::swap(a[i], b[i]);
   }
 #else
   constexpr size_t varSizes[] = {SPEEDCHANGE_GENES, HEADING_GENES, VERRATE_GENES,
@@ -283,13 +304,25 @@ std::pair<Chromosome, Chromosome> Chromosome::crossoverTwo(const Chromosome& oth
 
     if (dist(rng) < 0.5) {
       for (size_t i = 0; i < varSize; ++i) {
-        std::swap(child1.genes[startIdx + i], child2.genes[startIdx + i]);
+        std::swap(a[startIdx + i], b[startIdx + i]);
       }
     }
 
     startIdx += varSize;
   }
 #endif
+}
+
+void Chromosome::mutate(Rng& rng, double mutationRate) {
+  scored = false;
+  mutateRow(genes.data(), bounds.data(), mutationRate, rng);
+}
+
+std::pair<Chromosome, Chromosome> Chromosome::crossoverTwo(const Chromosome& other,
+                                                           Rng&              rng) const {
+  Chromosome child1 = *this;
+  Chromosome child2 = other;
+  crossoverRows(child1.genes.data(), child2.genes.data(), rng);
 
   child1.updateBounds();
   child2.updateBounds();
@@ -300,11 +333,8 @@ std::pair<Chromosome, Chromosome> Chromosome::crossoverTwo(const Chromosome& oth
 }
 
 void Chromosome::crossover(const Chromosome& parent1, const Chromosome& parent2,
-                           Chromosome& offspring1, Chromosome& offspring2) {
-  static std::random_device rd;
-  static std::mt19937       gen(rd());
-
-  auto children = parent1.crossoverTwo(parent2, gen);
+                           Chromosome& offspring1, Chromosome& offspring2, Rng& rng) {
+  auto children = parent1.crossoverTwo(parent2, rng);
   offspring1 = children.first;
   offspring2 = children.second;
 }
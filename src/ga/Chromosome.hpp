@@ -1,7 +1,8 @@
 #pragma once
+#include "Rng.hpp"
 #include "ga_config.hpp"
 
-#include <random>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
 
@@ -17,21 +18,51 @@ struct VariableScope {
   double max;
 };
 
+// FNV-1a over the bytes of `count` genes.
+uint64_t hashGenes(const double* genes, size_t count);
+
+// Genetic operators on one row of TOTAL_GENES genes, in place and without
+// allocating. Population applies them to the rows of its gene matrix;
+// Chromosome's members forward to them.
+void updateRowBounds(const double* genes, GeneBounds* bounds);
+void repairRow(double* genes, const GeneBounds* bounds);
+void mutateRow(double* genes, const GeneBounds* bounds, double mutationRate, Rng& rng);
+
+// Like mutateRow(), but moves each chosen gene by a normal deviate of `step`
+// times its bound width, clamped to the bounds, so small steps refine a row
+// where uniform redraws would scatter it.
+void gaussianMutateRow(double* genes, const GeneBounds* bounds, double mutationRate, double step,
+                       Rng& rng);
+
+// Swaps each variable's gene block between the rows with probability 1/2;
+// bounds are left for the caller to refresh.
+void crossoverRows(double* a, double* b, Rng& rng);
+
 class Chromosome {
 public:
   std::vector<double>     genes;
   std::vector<GeneBounds> bounds;
 
+  // Fitness of the current genes, valid while `scored` is set. mutate() and
+  // repair() clear it; code that edits genes directly must clear it as well.
+  double fitness = 0.0;
+  bool   scored = false;
+
   Chromosome();
 
   void updateBounds();
   void repair();
-  void mutate(double mutationRate = 0.3);
+  // Per-gene probability that mutate() perturbs a gene.
+  static constexpr double DEFAULT_MUTATION_RATE = 0.3;
+
+  void mutate(Rng& rng, double mutationRate = DEFAULT_MUTATION_RATE);
+
+  uint64_t hash() const { return hashGenes(genes.data(), genes.size()); }
 
-  std::pair<Chromosome, Chromosome> crossoverTwo(const Chromosome& other, std::mt19937& rng) const;
+  std::pair<Chromosome, Chromosome> crossoverTwo(const Chromosome& other, Rng& rng) const;
 
   static void crossover(const Chromosome& parent1, const Chromosome& parent2,
-                        Chromosome& offspring1, Chromosome& offspring2);
+                        Chromosome& offspring1, Chromosome& offspring2, Rng& rng);
 
   static const std::vector<double> DEFAULT_GENES;
 };
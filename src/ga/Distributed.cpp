@@ -0,0 +1,598 @@
+#include "Distributed.hpp"
+
+#include "../dataset/Dataset.hpp"
+#include "Chromosome.hpp"
+#include "Fitness.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ga {
+namespace {
+
+// Every message is a FrameHeader followed by `bytes` of payload. Messages to
+// workers keep their payload a multiple of 8 bytes so it can be read straight
+// into doubles.
+constexpr uint32_t PROTOCOL_VERSION = 2;
+constexpr uint64_t MAX_FRAME_BYTES = uint64_t(1) << 30;
+
+enum FrameType : uint32_t {
+  HELLO = 1, // worker: u32 protocol version, u32 threads
+  JOB,       // coordinator: u32 genes, u32 inference mode, u64 key, u64 begin row,
+             // u64 end row, u64 path length, path padded to 8 bytes; `count` is
+             // the job generation
+  READY,     // worker: the job is loaded; `count` echoes its generation
+  FAILED,    // worker: error message; the worker then exits
+  TASK,      // coordinator: u64 task id, `count` rows of TOTAL_GENES genes
+  RESULT     // worker: u64 task id, `count` fitness values
+};
+
+struct FrameHeader {
+  uint32_t type;
+  uint32_t count;
+  uint64_t bytes;
+};
+
+void put(std::vector<char>& buffer, const void* data, size_t bytes) {
+  const char* p = static_cast<const char*>(data);
+  buffer.insert(buffer.end(), p, p + bytes);
+}
+
+template <typename T> void put(std::vector<char>& buffer, T value) {
+  put(buffer, &value, sizeof(value));
+}
+
+template <typename T> T get(const char*& p) {
+  T value;
+  std::memcpy(&value, p, sizeof(value));
+  p += sizeof(value);
+  return value;
+}
+
+// Starts a frame in `buffer`; endFrame() fills in the payload size.
+void beginFrame(std::vector<char>& buffer, uint32_t type, uint32_t count) {
+  buffer.clear();
+  put(buffer, FrameHeader{type, count, 0});
+}
+
+void endFrame(std::vector<char>& buffer) {
+  uint64_t bytes = buffer.size() - sizeof(FrameHeader);
+  std::memcpy(buffer.data() + offsetof(FrameHeader, bytes), &bytes, sizeof(bytes));
+}
+
+// "unix:/path" or "host:port".
+struct Endpoint {
+  bool        local = false; // UNIX socket
+  std::string path;
+  std::string host;
+  std::string port;
+};
+
+Endpoint parseEndpoint(const std::string& address) {
+  Endpoint endpoint;
+  if (address.rfind("unix:", 0) == 0) {
+    endpoint.local = true;
+    endpoint.path = address.substr(5);
+    if (endpoint.path.empty() || endpoint.path.size() >= sizeof(sockaddr_un::sun_path))
+      throw std::runtime_error("Invalid UNIX socket path: " + address);
+    return endpoint;
+  }
+
+  size_t colon = address.rfind(':');
+  if (colon == std::string::npos || colon + 1 == address.size())
+    throw std::runtime_error("Address must be host:port or unix:/path: " + address);
+  endpoint.host = address.substr(0, colon);
+  endpoint.port = address.substr(colon + 1);
+  return endpoint;
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  return addr;
+}
+
+// Connected socket, or -1 if nothing is listening at `address` yet.
+int connectTo(const std::string& address) {
+  Endpoint endpoint = parseEndpoint(address);
+  if (endpoint.local) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+      throw std::runtime_error("Failed to create socket");
+    sockaddr_un addr = unixAddress(endpoint.path);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  addrinfo  hints = {};
+  addrinfo* found = nullptr;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (::getaddrinfo(endpoint.host.empty() ? "localhost" : endpoint.host.c_str(),
+                    endpoint.port.c_str(), &hints, &found) != 0)
+    throw std::runtime_error("Cannot resolve coordinator address: " + address);
+
+  int fd = -1;
+  for (addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+    fd = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+    if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  ::freeaddrinfo(found);
+  if (fd >= 0) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+// Blocking I/O for the worker; false once the peer is gone.
+bool readAll(int fd, void* data, size_t bytes) {
+  char* p = static_cast<char*>(data);
+  while (bytes > 0) {
+    ssize_t n = ::recv(fd, p, bytes, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    bytes -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool writeAll(int fd, const std::vector<char>& buffer) {
+  const char* p = buffer.data();
+  size_t      bytes = buffer.size();
+  while (bytes > 0) {
+    ssize_t n = ::send(fd, p, bytes, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    bytes -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Writes to a non-blocking socket, waiting up to `timeout` for buffer space.
+bool sendAll(int fd, const std::vector<char>& buffer, std::chrono::duration<double> timeout) {
+  auto        deadline = std::chrono::steady_clock::now() + timeout;
+  const char* p = buffer.data();
+  size_t      bytes = buffer.size();
+  while (bytes > 0) {
+    ssize_t n = ::send(fd, p, bytes, MSG_NOSIGNAL);
+    if (n > 0) {
+      p += n;
+      bytes -= static_cast<size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+      return false;
+
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    pollfd pfd = {fd, POLLOUT, 0};
+    if (left.count() <= 0 || ::poll(&pfd, 1, static_cast<int>(left.count())) <= 0)
+      return false;
+  }
+  return true;
+}
+
+bool sameJob(const WorkerJob& a, const WorkerJob& b) {
+  return a.path == b.path && a.key == b.key && a.beginRow == b.beginRow &&
+         a.endRow == b.endRow && a.inferenceMode == b.inferenceMode;
+}
+
+// Builds the worker's evaluator for a JOB payload.
+std::unique_ptr<Fitness> loadJob(const char* p, size_t bytes, size_t threads,
+                                 const std::string& dataPath) {
+  constexpr size_t FIXED = 2 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+  if (bytes < FIXED)
+    throw std::runtime_error("Malformed job from coordinator");
+
+  uint32_t    genes = get<uint32_t>(p);
+  uint32_t    mode = get<uint32_t>(p);
+  uint64_t    key = get<uint64_t>(p);
+  uint64_t    beginRow = get<uint64_t>(p);
+  uint64_t    endRow = get<uint64_t>(p);
+  uint64_t    pathLength = get<uint64_t>(p);
+  std::string path(p, std::min<uint64_t>(pathLength, bytes - FIXED));
+  if (genes != TOTAL_GENES)
+    throw std::runtime_error("Coordinator sends " + std::to_string(genes) + " genes, worker has " +
+                             std::to_string(TOTAL_GENES));
+
+  auto file = std::make_shared<const dataset::MappedColumnarFile>(dataPath.empty() ? path
+                                                                                   : dataPath);
+  if (file->key() != key)
+    throw std::runtime_error("Training file " + file->path() + " differs from the coordinator's");
+  if (endRow > file->rows() || beginRow > endRow)
+    throw std::runtime_error("Job rows out of range for " + file->path());
+
+  auto fitness = std::make_unique<Fitness>(
+      dataset::DatasetView(dataset::Dataset::fromMapped(file), beginRow, endRow));
+  fitness->setInferenceMode(static_cast<fuzzy::InferenceMode>(mode));
+  fitness->setThreads(threads);
+  return fitness;
+}
+} // namespace
+
+Coordinator::Coordinator(const std::string& address) : address_(address) {
+  Endpoint endpoint = parseEndpoint(address);
+  if (endpoint.local) {
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    ::unlink(endpoint.path.c_str());
+    sockaddr_un addr = unixAddress(endpoint.path);
+    if (listenFd_ < 0 || ::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      if (listenFd_ >= 0)
+        ::close(listenFd_);
+      throw std::runtime_error("Cannot listen on " + address + ": " + std::strerror(errno));
+    }
+    unixPath_ = endpoint.path;
+  } else {
+    addrinfo  hints = {};
+    addrinfo* found = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (::getaddrinfo(endpoint.host.empty() ? nullptr : endpoint.host.c_str(),
+                      endpoint.port.c_str(), &hints, &found) != 0)
+      throw std::runtime_error("Cannot resolve listen address: " + address);
+
+    for (addrinfo* a = found; a && listenFd_ < 0; a = a->ai_next) {
+      listenFd_ = ::socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                           a->ai_protocol);
+      int one = 1;
+      if (listenFd_ >= 0 &&
+          (::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+           ::bind(listenFd_, a->ai_addr, a->ai_addrlen) != 0)) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+      }
+    }
+    ::freeaddrinfo(found);
+    if (listenFd_ < 0)
+      throw std::runtime_error("Cannot listen on " + address + ": " + std::strerror(errno));
+  }
+
+  if (::listen(listenFd_, 64) != 0) {
+    ::close(listenFd_);
+    throw std::runtime_error("Cannot listen on " + address + ": " + std::strerror(errno));
+  }
+}
+
+Coordinator::~Coordinator() {
+  // Workers see the connection close and exit.
+  for (Connection& c : connections_)
+    ::close(c.fd);
+  ::close(listenFd_);
+  if (!unixPath_.empty())
+    ::unlink(unixPath_.c_str());
+}
+
+void Coordinator::setJob(const WorkerJob& job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hasJob_ && sameJob(job, job_))
+    return;
+  job_ = job;
+  hasJob_ = true;
+  ++jobGeneration_;
+
+  for (Connection& c : connections_) {
+    if (c.state != State::HANDSHAKE)
+      sendJob(c);
+  }
+  connections_.erase(std::remove_if(connections_.begin(), connections_.end(),
+                                    [](const Connection& c) { return c.fd < 0; }),
+                     connections_.end());
+}
+
+size_t Coordinator::workers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<size_t>(std::count_if(
+      connections_.begin(), connections_.end(),
+      [](const Connection& c) { return c.state == State::IDLE || c.state == State::BUSY; }));
+}
+
+DistributedStats Coordinator::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void Coordinator::acceptWorkers() {
+  for (;;) {
+    int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+      return;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    Connection c;
+    c.fd = fd;
+    c.sent = std::chrono::steady_clock::now();
+    connections_.push_back(std::move(c));
+  }
+}
+
+void Coordinator::sendJob(Connection& c) {
+  beginFrame(sendBuffer_, JOB, jobGeneration_);
+  put(sendBuffer_, static_cast<uint32_t>(TOTAL_GENES));
+  put(sendBuffer_, job_.inferenceMode);
+  put(sendBuffer_, job_.key);
+  put(sendBuffer_, job_.beginRow);
+  put(sendBuffer_, job_.endRow);
+  put(sendBuffer_, static_cast<uint64_t>(job_.path.size()));
+  put(sendBuffer_, job_.path.data(), job_.path.size());
+  sendBuffer_.resize(sizeof(FrameHeader) + (sendBuffer_.size() - sizeof(FrameHeader) + 7) / 8 * 8);
+  endFrame(sendBuffer_);
+
+  c.state = State::LOADING;
+  c.sent = std::chrono::steady_clock::now();
+  if (!sendAll(c.fd, sendBuffer_, timeout_))
+    drop(c, "could not send the job");
+}
+
+bool Coordinator::sendTask(Connection& c, const std::vector<const double*>& rows, size_t first,
+                           size_t count) {
+  beginFrame(sendBuffer_, TASK, static_cast<uint32_t>(count));
+  put(sendBuffer_, nextTask_);
+  for (size_t r = first; r < first + count; ++r)
+    put(sendBuffer_, rows[r], TOTAL_GENES * sizeof(double));
+  endFrame(sendBuffer_);
+
+  c.state = State::BUSY;
+  c.task = nextTask_++;
+  c.first = first;
+  c.count = count;
+  c.sent = std::chrono::steady_clock::now();
+  ++stats_.tasks;
+  if (!sendAll(c.fd, sendBuffer_, timeout_)) {
+    drop(c, "could not send a task");
+    return false;
+  }
+  return true;
+}
+
+bool Coordinator::receive(Connection& c, std::vector<double>& out, size_t& done) {
+  bool closed = false;
+  char chunk[65536];
+  for (;;) {
+    ssize_t n = ::recv(c.fd, chunk, sizeof(chunk), 0);
+    if (n > 0) {
+      c.received.insert(c.received.end(), chunk, chunk + n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    closed = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+    break;
+  }
+
+  size_t offset = 0;
+  while (c.received.size() - offset >= sizeof(FrameHeader)) {
+    FrameHeader header;
+    std::memcpy(&header, c.received.data() + offset, sizeof(header));
+    if (header.bytes > MAX_FRAME_BYTES)
+      return false;
+    if (c.received.size() - offset - sizeof(header) < header.bytes)
+      break;
+    const char* p = c.received.data() + offset + sizeof(header);
+    offset += sizeof(header) + header.bytes;
+
+    switch (header.type) {
+    case HELLO:
+      if (c.state != State::HANDSHAKE || header.bytes < 2 * sizeof(uint32_t) ||
+          get<uint32_t>(p) != PROTOCOL_VERSION)
+        return false;
+      ++stats_.workersJoined;
+      sendJob(c);
+      if (c.fd < 0)
+        return true;
+      break;
+    case READY:
+      // A worker sent a new job while loading the previous one answers both;
+      // it is ready only once it has loaded the current one.
+      if (header.count != jobGeneration_)
+        break;
+      if (c.state != State::LOADING)
+        return false;
+      c.state = State::IDLE;
+      break;
+    case FAILED:
+      std::cerr << "Fitness worker failed: " << std::string(p, header.bytes) << "\n";
+      return false;
+    case RESULT:
+      // A result for a task given up on earlier is dropped with the worker, so
+      // anything else is a protocol error.
+      if (c.state != State::BUSY || header.count != c.count ||
+          header.bytes != sizeof(uint64_t) + c.count * sizeof(double) ||
+          get<uint64_t>(p) != c.task)
+        return false;
+      std::memcpy(out.data() + c.first, p, c.count * sizeof(double));
+      done += c.count;
+      c.state = State::IDLE;
+      break;
+    default:
+      return false;
+    }
+  }
+  c.received.erase(c.received.begin(), c.received.begin() + static_cast<std::ptrdiff_t>(offset));
+  return !closed;
+}
+
+void Coordinator::drop(Connection& c, const std::string& reason) {
+  if (c.fd < 0)
+    return;
+  if (c.state != State::HANDSHAKE) {
+    ++stats_.workersLost;
+    std::cerr << "Fitness worker dropped: " << reason << "\n";
+  }
+  if (c.state == State::BUSY) {
+    retry_.emplace_front(c.first, c.count);
+    ++stats_.reassigned;
+  }
+  ::close(c.fd);
+  c.fd = -1;
+}
+
+void Coordinator::evaluate(const std::vector<const double*>& rows, std::vector<double>& out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!hasJob_)
+    throw std::runtime_error("Coordinator has no job; call setJob() first");
+
+  out.resize(rows.size());
+  retry_.clear();
+  size_t              next = 0, done = 0;
+  auto                lastAlive = std::chrono::steady_clock::now();
+  std::vector<pollfd> fds;
+
+  while (done < rows.size()) {
+    acceptWorkers();
+
+    // Tasks of about a quarter of an even share, so faster workers take more.
+    size_t ready = static_cast<size_t>(std::count_if(
+        connections_.begin(), connections_.end(),
+        [](const Connection& c) { return c.state == State::IDLE || c.state == State::BUSY; }));
+    size_t chunk = std::max<size_t>(1, rows.size() / (4 * std::max<size_t>(1, ready)));
+    for (Connection& c : connections_) {
+      if (c.state != State::IDLE || c.fd < 0)
+        continue;
+      if (!retry_.empty()) {
+        auto [first, count] = retry_.front();
+        retry_.pop_front();
+        sendTask(c, rows, first, count);
+      } else if (next < rows.size()) {
+        size_t count = std::min(chunk, rows.size() - next);
+        sendTask(c, rows, next, count);
+        next += count;
+      }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    bool alive = false;
+    for (Connection& c : connections_) {
+      if (c.fd < 0)
+        continue;
+      if (c.state != State::IDLE && now - c.sent > timeout_)
+        drop(c, "timed out");
+      else if (c.state != State::HANDSHAKE)
+        alive = true;
+    }
+    if (alive)
+      lastAlive = now;
+    else if (now - lastAlive > timeout_)
+      throw std::runtime_error("No fitness workers connected to " + address_);
+
+    connections_.erase(std::remove_if(connections_.begin(), connections_.end(),
+                                      [](const Connection& c) { return c.fd < 0; }),
+                       connections_.end());
+
+    fds.clear();
+    fds.push_back({listenFd_, POLLIN, 0});
+    for (const Connection& c : connections_)
+      fds.push_back({c.fd, POLLIN, 0});
+    if (::poll(fds.data(), fds.size(), 100) <= 0)
+      continue;
+
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      Connection& c = connections_[i];
+      if (fds[i + 1].revents && c.fd >= 0 && !receive(c, out, done))
+        drop(c, "connection lost");
+    }
+  }
+}
+
+void runWorker(const std::string& address, size_t threads, const std::string& dataPath,
+               double connectTimeout) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(connectTimeout);
+  int  fd;
+  while ((fd = connectTo(address)) < 0) {
+    if (std::chrono::steady_clock::now() >= deadline)
+      throw std::runtime_error("Could not connect to coordinator at " + address);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  std::unique_ptr<int, void (*)(int*)> closer(&fd, [](int* f) { ::close(*f); });
+
+  std::vector<char> buffer;
+  beginFrame(buffer, HELLO, 0);
+  put(buffer, PROTOCOL_VERSION);
+  put(buffer, static_cast<uint32_t>(threads));
+  endFrame(buffer);
+  if (!writeAll(fd, buffer))
+    return;
+
+  std::unique_ptr<Fitness>   fitness;
+  std::vector<double>        payload;
+  std::vector<const double*> rows;
+  std::vector<double>        results;
+
+  for (;;) {
+    FrameHeader header;
+    if (!readAll(fd, &header, sizeof(header)))
+      return; // the coordinator is done
+    if (header.bytes > MAX_FRAME_BYTES || header.bytes % sizeof(double) != 0)
+      throw std::runtime_error("Malformed message from coordinator");
+    payload.resize(header.bytes / sizeof(double));
+    if (!readAll(fd, payload.data(), header.bytes))
+      return;
+    const char* p = reinterpret_cast<const char*>(payload.data());
+
+    if (header.type == JOB) {
+      try {
+        fitness = loadJob(p, header.bytes, threads, dataPath);
+      } catch (const std::exception& e) {
+        beginFrame(buffer, FAILED, 0);
+        put(buffer, e.what(), std::strlen(e.what()));
+        endFrame(buffer);
+        writeAll(fd, buffer);
+        throw;
+      }
+      beginFrame(buffer, READY, header.count);
+      endFrame(buffer);
+    } else if (header.type == TASK) {
+      const size_t rowBytes = TOTAL_GENES * sizeof(double);
+      if (!fitness || header.bytes != sizeof(uint64_t) + header.count * rowBytes)
+        throw std::runtime_error("Malformed task from coordinator");
+      uint64_t task = get<uint64_t>(p);
+      rows.clear();
+      for (size_t r = 0; r < header.count; ++r)
+        rows.push_back(payload.data() + 1 + r * TOTAL_GENES);
+      fitness->evaluateBatch(rows, results);
+
+      beginFrame(buffer, RESULT, header.count);
+      put(buffer, task);
+      put(buffer, results.data(), results.size() * sizeof(double));
+      endFrame(buffer);
+    } else {
+      throw std::runtime_error("Unexpected message from coordinator");
+    }
+
+    if (!writeAll(fd, buffer))
+      return;
+  }
+}
+} // namespace ga
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ga {
+
+// Training set a worker scores against: rows [beginRow, endRow) of a columnar
+// sample file (see dataset/ColumnarFile.hpp). `key` is the file's cache key, so
+// a worker whose copy of the file differs refuses the job.
+struct WorkerJob {
+  std::string path;
+  uint64_t    key = 0;
+  uint64_t    beginRow = 0;
+  uint64_t    endRow = 0;
+  uint32_t    inferenceMode = 0; // fuzzy::InferenceMode
+};
+
+// Counters of a Coordinator since construction.
+struct DistributedStats {
+  size_t workersJoined = 0; // connections that completed the handshake
+  size_t workersLost = 0;   // dropped: disconnected, failed the job or timed out
+  size_t tasks = 0;         // tasks sent
+  size_t reassigned = 0;    // tasks sent again after their worker was lost
+};
+
+// Farms fitness batches out to worker processes (see runWorker()) over TCP
+// ("host:port", empty host for any interface) or a UNIX socket ("unix:/path").
+//
+// Workers may connect at any time. Each is sent the job, maps its own copy of
+// the training file and, once it reports ready, is handed tasks of a few gene
+// rows at a time. A worker that disconnects, or takes longer than the timeout
+// to load the job or answer a task, is dropped and its task goes to another. Workers run the same Fitness code on
+// the same rows, so results match local scoring bit for bit; the wire format is
+// in host byte order, so all processes must share one architecture and build.
+class Coordinator {
+public:
+  explicit Coordinator(const std::string& address);
+  ~Coordinator();
+
+  Coordinator(const Coordinator&) = delete;
+  Coordinator& operator=(const Coordinator&) = delete;
+
+  // Sent to workers as they connect; connected workers reload on a change.
+  void setJob(const WorkerJob& job);
+
+  // evaluate() throws once no worker has been connected for this long, and a
+  // worker holding one task this long is dropped. Default 60 s.
+  void setTimeout(double seconds) { timeout_ = std::chrono::duration<double>(seconds); }
+
+  // One fitness per row of TOTAL_GENES genes; blocks until all are scored.
+  // Concurrent calls (e.g. from islands) take turns.
+  void evaluate(const std::vector<const double*>& rows, std::vector<double>& out);
+
+  // Workers ready for tasks, as of the last evaluate() or setJob().
+  size_t workers() const;
+
+  DistributedStats   stats() const;
+  const std::string& address() const { return address_; }
+
+private:
+  enum class State { HANDSHAKE, LOADING, IDLE, BUSY };
+
+  struct Connection {
+    int               fd;
+    State             state = State::HANDSHAKE;
+    std::vector<char> received; // bytes not yet parsed into frames
+    uint64_t          task = 0; // while BUSY: id and rows of the task
+    size_t            first = 0;
+    size_t            count = 0;
+    // When the connection, job or task now pending was started; every state
+    // but IDLE is dropped once this is older than the timeout.
+    std::chrono::steady_clock::time_point sent;
+  };
+
+  std::string                       address_;
+  std::string                       unixPath_; // removed on destruction
+  int                               listenFd_ = -1;
+  WorkerJob                         job_;
+  bool                              hasJob_ = false;
+  uint32_t                          jobGeneration_ = 0; // bumped by each new job
+  std::chrono::duration<double>     timeout_{60.0};
+  std::vector<Connection>           connections_;
+  uint64_t                          nextTask_ = 1;
+  DistributedStats                  stats_;
+  mutable std::mutex                mutex_; // one evaluate() or setJob() at a time
+  std::vector<char>                 sendBuffer_;
+  std::deque<std::pair<size_t, size_t>> retry_; // (first, count) of tasks to send again
+
+  void acceptWorkers();
+  void sendJob(Connection& c);
+  bool sendTask(Connection& c, const std::vector<const double*>& rows, size_t first,
+                size_t count);
+
+  // Reads what is available and handles complete frames; false if the
+  // connection must be dropped.
+  bool receive(Connection& c, std::vector<double>& out, size_t& done);
+
+  // Closes c; a task it held goes back to retry_.
+  void drop(Connection& c, const std::string& reason);
+};
+
+// Worker process loop: connects to the coordinator at `address` (retrying for
+// up to `connectTimeout` seconds, so workers may start first), maps the job's
+// training file, or `dataPath` when the worker keeps its copy elsewhere, and
+// scores tasks on `threads` threads (0 = one per core) until the coordinator
+// closes the connection. Throws std::runtime_error if it cannot get started.
+void runWorker(const std::string& address, size_t threads, const std::string& dataPath = "",
+               double connectTimeout = 30.0);
+} // namespace ga
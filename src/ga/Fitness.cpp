@@ -1,28 +1,115 @@
 #include "Fitness.hpp"
 
+#include "../dataset/ColumnarFile.hpp"
 #include "../fuzzy/FuzzyInferenceSystem.hpp"
+#include "Distributed.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <numeric>
 #include <stdexcept>
 
 // Only include fuzzy headers in production mode
 #ifndef GA_TEST_MODE
-#include "../fuzzy/AdsbFuzzyVariable.hpp"
-#include "../fuzzy/RuleBase.hpp"
+#include "../fuzzy/AdsbFuzzySystem.hpp"
 #endif
 
 namespace ga {
 
+Fitness::Fitness(dataset::DatasetView trainingSet) : samples_(std::move(trainingSet)) {
+  initFuzzySystem();
+  inputColumns_ = resolveInputColumns(samples_.data().featureNames());
+  calibrateRuleOrder();
+  setThreads(1);
+}
+
 Fitness::Fitness(const std::vector<std::map<std::string, double>>& inputs,
-                 const std::vector<double>&                        expectedOutputs)
-    : testInputs_(inputs), expectedOutputs_(expectedOutputs) {
+                 const std::vector<double>&                        expectedOutputs) {
   if (inputs.size() != expectedOutputs.size())
     throw std::runtime_error("Inputs and expected outputs size mismatch");
+
+  std::vector<std::string> names;
+  if (!inputs.empty()) {
+    for (const auto& [name, value] : inputs.front())
+      names.push_back(name);
+  }
+
+  samples_ = dataset::DatasetView(dataset::Dataset::fromSamples(names, inputs, expectedOutputs));
+  initFuzzySystem();
+  inputColumns_ = resolveInputColumns(names);
+  calibrateRuleOrder();
+  setThreads(1);
+}
+
+Fitness::Fitness(const StreamingSource& source) : streaming_(true), source_(source) {
+  dataset::MappedColumnarFile file(source_.path);
+  if (source_.endRow > file.rows() || source_.beginRow >= source_.endRow)
+    throw std::runtime_error("Invalid row range for streaming training set: " + source_.path);
+  if (source_.blockRows == 0)
+    throw std::runtime_error("Streaming block size must be > 0");
+
+  std::vector<std::string> names;
+  for (size_t f = 0; f < file.features(); ++f)
+    names.push_back(file.name(f));
+  initFuzzySystem();
+  inputColumns_ = resolveInputColumns(names);
+  setThreads(1);
+  reader_ = std::make_unique<dataset::ColumnarBlockReader>(source_.path, source_.beginRow,
+                                                           source_.endRow, source_.blockRows);
+  calibrateRuleOrder();
+}
+
+void Fitness::setThreads(size_t threads) {
+  pool_ = std::make_unique<ThreadPool>(threads);
+  workers_.assign(pool_->size(), Worker{fis_, {}, {}, {}, {}});
+}
+
+void Fitness::setInferenceMode(fuzzy::InferenceMode mode) {
+  fis_.setInferenceMode(mode);
+  for (auto& worker : workers_)
+    worker.fis.setInferenceMode(mode);
+  if (coordinator_)
+    coordinator_->setJob(workerJob());
+}
+
+void Fitness::setCoordinator(Coordinator* coordinator) {
+  if (coordinator)
+    coordinator->setJob(workerJob());
+  coordinator_ = coordinator;
+}
+
+WorkerJob Fitness::workerJob() const {
+  WorkerJob job;
+  if (streaming_) {
+    job.path = source_.path;
+    job.beginRow = source_.beginRow;
+    job.endRow = source_.endRow;
+  } else {
+    if (!samples_.contiguous() || samples_.data().sourceFile().empty())
+      throw std::runtime_error("Remote fitness needs a training set backed by a columnar file");
+    job.path = samples_.data().sourceFile();
+    job.beginRow = samples_.empty() ? 0 : samples_.rowIndex(0);
+    job.endRow = job.beginRow + samples_.size();
+  }
+  job.key = dataset::MappedColumnarFile(job.path).key();
+  job.inferenceMode = static_cast<uint32_t>(fis_.getInferenceMode());
+  return job;
+}
+
+void Fitness::setMembershipCacheBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  cacheBytes_ = bytes;
+  for (auto& entries : cache_)
+    entries.clear();
+  cachedBytes_ = 0;
 }
 
 #ifdef GA_TEST_MODE
 
-double Fitness::evaluate(const Chromosome& c) {
+// Stand-in fitness over a gene vector: no dataset, just a smooth function of
+// the genes.
+static double simulatedFitness(const double* genes) {
   const size_t numTestCases = 10;
   double       totalError = 0.0;
 
@@ -32,13 +119,13 @@ double Fitness::evaluate(const Chromosome& c) {
     double fuzzyOutput = 0.0;
     double totalWeight = 0.0;
 
-    for (size_t g = 0; g < c.genes.size(); ++g) {
-      double center = c.genes[g] / 10.0;
+    for (size_t g = 0; g < TOTAL_GENES; ++g) {
+      double center = genes[g] / 10.0;
       double distance = std::abs(simulatedInput - center);
 
       double membership = std::exp(-distance * distance / 0.1);
 
-      fuzzyOutput += membership * c.genes[g];
+      fuzzyOutput += membership * genes[g];
       totalWeight += membership;
     }
 
@@ -56,49 +143,151 @@ double Fitness::evaluate(const Chromosome& c) {
   return 100.0 / (1.0 + mse);
 }
 
+double Fitness::evaluate(const Chromosome& c) { return simulatedFitness(c.genes.data()); }
+
+void Fitness::evaluateBatch(const std::vector<const Chromosome*>& batch,
+                            std::vector<double>&                  out) {
+  out.resize(batch.size());
+  for (size_t c = 0; c < batch.size(); ++c)
+    out[c] = evaluate(*batch[c]);
+}
+
+void Fitness::evaluateBatch(const std::vector<const double*>& batch, std::vector<double>& out) {
+  out.resize(batch.size());
+  for (size_t c = 0; c < batch.size(); ++c)
+    out[c] = simulatedFitness(batch[c]);
+}
+
+void Fitness::initFuzzySystem() {}
+
+void Fitness::calibrateRuleOrder() {}
+
+std::vector<size_t> Fitness::resolveInputColumns(const std::vector<std::string>& columns) {
+  std::vector<size_t> resolved(columns.size());
+  std::iota(resolved.begin(), resolved.end(), 0);
+  return resolved;
+}
+
 #else
 
+namespace {
+
+// Rows gathered per evaluateBatch() call for non-contiguous training views.
+constexpr size_t INFERENCE_BLOCK_ROWS = 4096;
+
+// Rows used to rank antecedent selectivity.
+constexpr size_t CALIBRATION_ROWS = 65536;
+
+double sampleWeight(double target) {
+  if (target >= 0.8)
+    return 10.0;
+  if (target >= 0.4)
+    return 5.0;
+  if (target > 0.0)
+    return 2.0;
+  return 1.0;
+}
+
+} // namespace
+
+void Fitness::initFuzzySystem() {
+  fis_ = fuzzy::createAdsbFuzzySystem();
+  if (fis_.parameterCount() != TOTAL_GENES)
+    throw std::runtime_error("Fuzzy system parameter count does not match chromosome size");
+
+  const size_t inputs = fis_.inputNames().size();
+  geneBlock_.assign(1, 0);
+  for (size_t v = 0; v < inputs; ++v)
+    geneBlock_.push_back(geneBlock_.back() + fis_.inputParameterCount(v));
+  cache_.assign(inputs, {});
+}
+
+void Fitness::calibrateRuleOrder() {
+  // A leading slice is plenty to rank term selectivity. Streaming mode takes
+  // the reader's first block, then rewinds it for the first pass.
+  if (streaming_) {
+    std::vector<const double*> columns(inputColumns_.size());
+    if (const dataset::ColumnarBlock* block = reader_->next()) {
+      const size_t count = std::min(block->rows, CALIBRATION_ROWS);
+      for (size_t v = 0; v < inputColumns_.size(); ++v)
+        columns[v] = block->column(inputColumns_[v]);
+      fis_.calibrateRuleOrder(columns.data(), count);
+    }
+    reader_->rewind();
+    return;
+  }
+
+  auto head = samples_.slice(0, std::min(samples_.size(), CALIBRATION_ROWS));
+  head.forEachBlock(inputColumns_, CALIBRATION_ROWS,
+                    [&](size_t, size_t count, const double* const* columns) {
+                      fis_.calibrateRuleOrder(columns, count);
+                    });
+}
+
+std::vector<size_t> Fitness::resolveInputColumns(const std::vector<std::string>& columns) {
+  std::vector<size_t> resolved;
+  for (const auto& name : fis_.inputNames()) {
+    auto it = std::find(columns.begin(), columns.end(), name);
+    if (it == columns.end())
+      throw std::runtime_error("Training data has no column for fuzzy input: " + name);
+    resolved.push_back(static_cast<size_t>(it - columns.begin()));
+  }
+  return resolved;
+}
+
 double Fitness::evaluate(const Chromosome& chromo) {
-  size_t idx = 0;
-  auto   nextGenes = [&](size_t count) -> std::vector<double> {
-    std::vector<double> v(chromo.genes.begin() + idx, chromo.genes.begin() + idx + count);
-    idx += count;
-    return v;
-  };
-
-  auto speedVar = fuzzy::createSpeedChangeVariable(nextGenes(13));
-  auto headingVar = fuzzy::createHeadingChangeVariable(nextGenes(13));
-  auto vertVar = fuzzy::createVerticalRateChangeVariable(nextGenes(13));
-  auto altVar = fuzzy::createAltitudeChangeVariable(nextGenes(13));
-  auto timeVar = fuzzy::createTimeGapVariable(nextGenes(7));
-  auto anomalyVar = fuzzy::createAnomalyLevelVariable(nextGenes(7));
-
-  fuzzy::FuzzyInferenceSystem fis;
-  fis.addInputVariable(speedVar);
-  fis.addInputVariable(headingVar);
-  fis.addInputVariable(vertVar);
-  fis.addInputVariable(altVar);
-  fis.addInputVariable(timeVar);
-  fis.setOutputVariable(anomalyVar);
-
-  for (const auto& rule : fuzzy::createAdsbRuleBase())
-    fis.addRule(rule);
+  if (streaming_) {
+    std::vector<double> out;
+    evaluateBatch({&chromo}, out);
+    return out[0];
+  }
+  return score(workers_[0], chromo.genes.data());
+}
+
+double Fitness::score(Worker& worker, const double* genes) {
+  fuzzy::FuzzyInferenceSystem& fis = worker.fis;
+  std::vector<double>&         outputs = worker.outputs;
+  fis.setParameters(genes);
+
+  outputs.resize(samples_.size());
+  if (cacheBytes_ == 0) {
+    samples_.forEachBlock(inputColumns_, INFERENCE_BLOCK_ROWS,
+                          [&](size_t first, size_t count, const double* const* columns) {
+                            fis.evaluateBatch(columns, count, outputs.data() + first);
+                          });
+  } else {
+    // Reuse the degrees of every input whose gene block was seen before; only
+    // rule firing and defuzzification run over the samples.
+    auto& held = worker.held;
+    auto& termColumns = worker.termColumns;
+    auto& blockColumns = worker.blockColumns;
+    held.clear();
+    termColumns.clear();
+    for (size_t v = 0; v < geneBlock_.size() - 1; ++v) {
+      held.push_back(membershipColumns(fis, v, genes + geneBlock_[v]));
+      for (size_t t = 0; t < fis.inputTermCount(v); ++t)
+        termColumns.push_back(held.back()->data() + t * samples_.size());
+    }
+
+    blockColumns.resize(termColumns.size());
+    samples_.forEachBlock(inputColumns_, INFERENCE_BLOCK_ROWS,
+                          [&](size_t first, size_t count, const double* const* columns) {
+                            for (size_t d = 0; d < termColumns.size(); ++d)
+                              blockColumns[d] = termColumns[d] + first;
+                            fis.evaluateBatch(columns, blockColumns.data(), count,
+                                              outputs.data() + first);
+                          });
+    // Release evicted entries now rather than at this worker's next call.
+    held.clear();
+  }
 
   double weightedMse = 0.0;
   double totalWeight = 0.0;
 
-  for (size_t i = 0; i < testInputs_.size(); ++i) {
-    double out = fis.evaluate(testInputs_[i]);
-    double target = expectedOutputs_[i];
-    double err = out - target;
-
-    double weight = 1.0;
-    if (target >= 0.8)
-      weight = 10.0;
-    else if (target >= 0.4)
-      weight = 5.0;
-    else if (target > 0.0)
-      weight = 2.0;
+  for (size_t i = 0; i < samples_.size(); ++i) {
+    double target = samples_.label(i);
+    double err = outputs[i] - target;
+    double weight = sampleWeight(target);
 
     weightedMse += weight * (err * err);
     totalWeight += weight;
@@ -108,5 +297,127 @@ double Fitness::evaluate(const Chromosome& chromo) {
 
   return 1.0 / (1.0 + weightedMse);
 }
+
+std::shared_ptr<const std::vector<double>>
+Fitness::membershipColumns(const fuzzy::FuzzyInferenceSystem& fis, size_t v, const double* genes) {
+  const size_t   count = geneBlock_[v + 1] - geneBlock_[v];
+  const uint64_t key = hashGenes(genes, count);
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    for (auto& entry : cache_[v]) {
+      if (entry.key == key &&
+          std::memcmp(entry.genes.data(), genes, count * sizeof(double)) == 0) {
+        entry.lastUse = ++cacheClock_;
+        ++cacheStats_.hits;
+        return entry.degrees;
+      }
+    }
+    ++cacheStats_.misses;
+  }
+
+  // Fuzzified outside the lock; two threads missing on the same block both
+  // compute it and the second insert is dropped.
+  const size_t n = samples_.size();
+  const size_t terms = fis.inputTermCount(v);
+  auto         degrees = std::make_shared<std::vector<double>>(terms * n);
+  std::vector<double*> out(terms);
+  samples_.forEachBlock({inputColumns_[v]}, INFERENCE_BLOCK_ROWS,
+                        [&](size_t first, size_t rows, const double* const* columns) {
+                          for (size_t t = 0; t < terms; ++t)
+                            out[t] = degrees->data() + t * n + first;
+                          fis.fuzzifyInput(v, columns[0], rows, out.data());
+                        });
+
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  for (const auto& entry : cache_[v]) {
+    if (entry.key == key && std::memcmp(entry.genes.data(), genes, count * sizeof(double)) == 0)
+      return degrees;
+  }
+  const size_t bytes = degrees->size() * sizeof(double);
+  if (makeRoom(bytes)) {
+    cachedBytes_ += bytes;
+    cache_[v].push_back({key, std::vector<double>(genes, genes + count), degrees, ++cacheClock_});
+  }
+  return degrees;
+}
+
+bool Fitness::makeRoom(size_t bytes) {
+  if (bytes > cacheBytes_)
+    return false;
+  while (cachedBytes_ + bytes > cacheBytes_) {
+    std::vector<MembershipColumns>* oldestVar = nullptr;
+    size_t                          oldest = 0;
+    for (auto& entries : cache_) {
+      for (size_t e = 0; e < entries.size(); ++e) {
+        if (!oldestVar || entries[e].lastUse < (*oldestVar)[oldest].lastUse) {
+          oldestVar = &entries;
+          oldest = e;
+        }
+      }
+    }
+    cachedBytes_ -= (*oldestVar)[oldest].degrees->size() * sizeof(double);
+    oldestVar->erase(oldestVar->begin() + static_cast<std::ptrdiff_t>(oldest));
+  }
+  return true;
+}
+
+void Fitness::evaluateBatch(const std::vector<const Chromosome*>& batch,
+                            std::vector<double>&                  out) {
+  std::vector<const double*> rows;
+  rows.reserve(batch.size());
+  for (const Chromosome* c : batch)
+    rows.push_back(c->genes.data());
+  evaluateBatch(rows, out);
+}
+
+void Fitness::evaluateBatch(const std::vector<const double*>& batch, std::vector<double>& out) {
+  if (coordinator_) {
+    coordinator_->evaluate(batch, out);
+    return;
+  }
+
+  out.resize(batch.size());
+  if (!streaming_) {
+    pool_->parallelFor(batch.size(), [&](size_t c, size_t worker) {
+      out[c] = score(workers_[worker], batch[c]);
+    });
+    return;
+  }
+
+  std::vector<double>        weightedMse(batch.size(), 0.0);
+  std::vector<double>        totalWeight(batch.size(), 0.0);
+  std::vector<const double*> columns(inputColumns_.size());
+
+  // Rewound as soon as a pass ends, so the next pass's first blocks are read
+  // while the population breeds.
+  struct Rewind {
+    dataset::ColumnarBlockReader& reader;
+    ~Rewind() { reader.rewind(); }
+  } rewind{*reader_};
+
+  while (const dataset::ColumnarBlock* block = reader_->next()) {
+    const double* labels = block->labels();
+    for (size_t v = 0; v < inputColumns_.size(); ++v)
+      columns[v] = block->column(inputColumns_[v]);
+
+    // Each chromosome's sums only ever advance on one thread per block, in
+    // block order, so they come out the same for any thread count.
+    pool_->parallelFor(batch.size(), [&](size_t c, size_t w) {
+      Worker& worker = workers_[w];
+      worker.outputs.resize(block->rows);
+      worker.fis.setParameters(batch[c]);
+      worker.fis.evaluateBatch(columns.data(), block->rows, worker.outputs.data());
+      for (size_t i = 0; i < block->rows; ++i) {
+        double err = worker.outputs[i] - labels[i];
+        double weight = sampleWeight(labels[i]);
+        weightedMse[c] += weight * (err * err);
+        totalWeight[c] += weight;
+      }
+    });
+  }
+
+  for (size_t c = 0; c < batch.size(); ++c)
+    out[c] = 1.0 / (1.0 + weightedMse[c] / totalWeight[c]);
+}
 #endif
 } // namespace ga
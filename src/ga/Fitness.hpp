@@ -1,22 +1,161 @@
 #pragma once
+#include "../dataset/Dataset.hpp"
 #include "../fuzzy/FuzzyInferenceSystem.hpp"
 #include "Chromosome.hpp"
+#include "ThreadPool.hpp"
 #include "ga_config.hpp"
 
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace ga {
 
+class Coordinator;
+struct WorkerJob;
+
+// Training samples kept on disk in a columnar file (see dataset/ColumnarFile.hpp)
+// and streamed in blocks of `blockRows` rows on every fitness pass.
+struct StreamingSource {
+  std::string path;
+  size_t      beginRow = 0;
+  size_t      endRow = 0;
+  size_t      blockRows = 65536;
+};
+
+// Lookups in Fitness's membership column cache since construction.
+struct MembershipCacheStats {
+  size_t hits = 0;   // input variables whose cached degrees were reused
+  size_t misses = 0; // input variables fuzzified over the training set
+};
+
 class Fitness {
 public:
+  // Default byte budget of the membership column cache.
+  static constexpr size_t DEFAULT_MEMBERSHIP_CACHE_BYTES = size_t(512) << 20;
+
+  // Scores against a view of a shared dataset; no sample data is copied.
+  explicit Fitness(dataset::DatasetView trainingSet);
+
   Fitness(const std::vector<std::map<std::string, double>>& inputs,
           const std::vector<double>&                        expectedOutputs);
 
+  // Out-of-core mode: nothing but the current blocks is kept in memory.
+  explicit Fitness(const StreamingSource& source);
+
   double evaluate(const Chromosome& chromo);
 
+  // Evaluates a whole batch (typically one generation) in a single pass over the
+  // training data. In streaming mode every block is scored against all
+  // chromosomes while it is resident, so the file is read once per batch.
+  // Chromosomes are spread over the thread pool; each result is computed by one
+  // thread start to finish, so it does not depend on the thread count.
+  void evaluateBatch(const std::vector<const Chromosome*>& batch, std::vector<double>& out);
+
+  // Same, for gene vectors given as rows of TOTAL_GENES values (e.g. GeneMatrix
+  // rows). `out` is resized, so a caller reusing it does not reallocate.
+  void evaluateBatch(const std::vector<const double*>& batch, std::vector<double>& out);
+
+  bool streaming() const { return streaming_; }
+
+  // Threads used by evaluateBatch(), the caller included (default 1; 0 = one
+  // per core).
+  void setThreads(size_t threads);
+
+  size_t threads() const { return workers_.size(); }
+
+  // Mamdani (default) or Sugeno inference for every chromosome scored here.
+  void setInferenceMode(fuzzy::InferenceMode mode);
+
+  // Sends evaluateBatch() to the coordinator's worker processes instead of
+  // scoring here; nullptr scores locally again. Workers map the training file
+  // themselves, so the training set must be a contiguous row range of a
+  // columnar file: the preprocessing cache, or a streaming source.
+  void setCoordinator(Coordinator* coordinator);
+
+  // Caps the memory held by cached membership columns; 0 disables the cache and
+  // every evaluation fuzzifies all inputs again.
+  void setMembershipCacheBytes(size_t bytes);
+
+  // Read between evaluations.
+  const MembershipCacheStats& membershipCacheStats() const { return cacheStats_; }
+
 private:
-  std::vector<std::map<std::string, double>> testInputs_;
-  std::vector<double>                        expectedOutputs_;
+  // Scoring state owned by one pool thread: the engine the chromosome's
+  // parameters are loaded into and its per-sample predictions.
+  struct Worker {
+    fuzzy::FuzzyInferenceSystem fis;
+    std::vector<double>         outputs;
+
+    // score() scratch, kept so repeated calls do not allocate.
+    std::vector<std::shared_ptr<const std::vector<double>>> held; // cached degrees in use
+    std::vector<const double*>                              termColumns;
+    std::vector<const double*>                              blockColumns;
+  };
+
+  dataset::DatasetView        samples_;
+  std::vector<size_t>         inputColumns_;
+  fuzzy::FuzzyInferenceSystem fis_; // configured and calibrated; copied into workers_
+
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<Worker>         workers_; // indexed by pool worker
+
+  bool            streaming_ = false;
+  StreamingSource source_;
+
+  // Streaming mode: one reader for every pass, rewound after each, so its
+  // buffers and read-ahead thread are set up once.
+  std::unique_ptr<dataset::ColumnarBlockReader> reader_;
+
+  Coordinator* coordinator_ = nullptr;
+
+  // Degrees of every term of one input variable over the whole training set for
+  // one value of that variable's gene block; term t of sample i sits at
+  // t * samples + i. Crossover swaps whole blocks and mutation touches few, so
+  // most chromosomes share most blocks with one already scored.
+  //
+  // Evaluations hold their own reference to the degrees, so evicting an entry
+  // never pulls columns out from under another thread.
+  struct MembershipColumns {
+    uint64_t                                   key;   // hash of the gene block
+    std::vector<double>                        genes; // compared on a hash match
+    std::shared_ptr<const std::vector<double>> degrees;
+    uint64_t                                   lastUse; // cacheClock_ at the last hit
+  };
+
+  std::vector<std::vector<MembershipColumns>> cache_; // per input variable
+  std::vector<size_t>  geneBlock_; // first gene of each input variable, plus end
+  std::mutex           cacheMutex_; // guards the cache and the fields below
+  size_t               cacheBytes_ = DEFAULT_MEMBERSHIP_CACHE_BYTES;
+  size_t               cachedBytes_ = 0;
+  uint64_t             cacheClock_ = 0;
+  MembershipCacheStats cacheStats_;
+
+  // Builds the rule base and variables once; evaluate() only swaps parameters.
+  void initFuzzySystem();
+
+  // Orders rule antecedents by how selective each term is on the training set.
+  void calibrateRuleOrder();
+
+  // Fitness of one gene vector on the in-memory training set.
+  double score(Worker& worker, const double* genes);
+
+  // Degree columns of input v for its gene block at `genes`, from the cache or
+  // fuzzified now with the parameters already loaded into `fis`.
+  std::shared_ptr<const std::vector<double>>
+  membershipColumns(const fuzzy::FuzzyInferenceSystem& fis, size_t v, const double* genes);
+
+  // Drops least recently used columns until `bytes` more fit in the budget;
+  // false if they cannot. Caller holds cacheMutex_.
+  bool makeRoom(size_t bytes);
+
+  // What a worker needs to score exactly as this object does.
+  WorkerJob workerJob() const;
+
+  // Dataset column feeding each fuzzy input, in fuzzy input order.
+  std::vector<size_t> resolveInputColumns(const std::vector<std::string>& columns);
 };
 } // namespace ga
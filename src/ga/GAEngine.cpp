@@ -1,8 +1,13 @@
 #include "GAEngine.hpp"
 
+#include "Checkpoint.hpp"
 #include "Fitness.hpp"
 #include "Selection.hpp"
+#include "ThreadPool.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <random>
@@ -10,64 +15,443 @@
 
 namespace ga {
 
+namespace {
+uint64_t randomSeed() {
+  std::random_device rd;
+  return (uint64_t(rd()) << 32) | rd();
+}
+
+void saveChromosome(CheckpointWriter& out, const Chromosome& c) {
+  out.putArray(c.genes.data(), TOTAL_GENES);
+  out.put(c.fitness);
+  out.put(uint8_t(c.scored));
+}
+
+void loadChromosome(CheckpointReader& in, Chromosome& c) {
+  in.getArray(c.genes.data(), TOTAL_GENES);
+  c.updateBounds();
+  c.fitness = in.get<double>();
+  c.scored = in.get<uint8_t>() != 0;
+}
+} // namespace
+
 GAEngine::GAEngine(size_t populationSize, size_t generations, double crossoverProb,
                    double mutationProb, size_t tournamentSize)
     : populationSize_(populationSize), generations_(generations), crossoverProb_(crossoverProb),
-      mutationProb_(mutationProb), tournamentSize_(tournamentSize), fitness_(nullptr),
-      population_(nullptr), bestFitness_(-std::numeric_limits<double>::infinity()) {}
+      mutationProb_(mutationProb), tournamentSize_(tournamentSize),
+      seed_(randomSeed()),
+      bestFitness_(-std::numeric_limits<double>::infinity()) {}
 
 void GAEngine::setFitnessEvaluator(Fitness* fitness) {
-  fitness_ = fitness;
-  if (fitness_) {
-    population_ = std::make_unique<Population>(populationSize_, *fitness_, crossoverProb_,
-                                               mutationProb_, tournamentSize_);
+  if (fitness)
+    setIslands({fitness});
+  else
+    islands_.clear();
+}
+
+void GAEngine::setIslands(const std::vector<Fitness*>& evaluators,
+                          const MigrationPolicy& migration) {
+  if (evaluators.empty() || populationSize_ < evaluators.size())
+    throw std::runtime_error("Need between 1 and populationSize islands");
+  if (evaluators.size() > 1 && migration.interval == 0)
+    throw std::runtime_error("Migration interval must be > 0");
+
+  // Sizes differ by at most one, so epochs take about as long on every island.
+  const size_t k = evaluators.size();
+  islands_.clear();
+  islands_.resize(k);
+  for (size_t i = 0; i < k; ++i) {
+    Island& island = islands_[i];
+    if (!evaluators[i])
+      throw std::runtime_error("Island fitness evaluator is null");
+
+    size_t size = populationSize_ * (i + 1) / k - populationSize_ * i / k;
+    if (migration.migrants >= size && k > 1)
+      throw std::runtime_error("Each island must keep more members than it sends");
+    island.fitness = evaluators[i];
+    island.population = std::make_unique<Population>(size, *evaluators[i], crossoverProb_,
+                                                     mutationProb_, tournamentSize_);
+    island.population->setAdaptiveVariation(adaptive_);
+    island.bestFitness = -std::numeric_limits<double>::infinity();
+    island.outgoing.resize(migration.migrants);
+    island.outgoingScores.resize(migration.migrants);
   }
+  migration_ = migration;
+  islandStats_.assign(k, IslandStats());
+}
+
+void GAEngine::setStoppingCriteria(const StoppingCriteria& criteria) {
+  if (criteria.validation && (criteria.validationInterval == 0 || criteria.validationPatience == 0))
+    throw std::runtime_error("Validation interval and patience must be > 0");
+  stopping_ = criteria;
 }
 
-void GAEngine::evaluatePopulation() {
-  if (!population_) {
-    throw std::runtime_error("Population not initialized. Call setFitnessEvaluator first.");
+void GAEngine::setAdaptiveVariation(const AdaptiveVariation& adaptive) {
+  for (Island& island : islands_)
+    island.population->setAdaptiveVariation(adaptive);
+  adaptive_ = adaptive;
+}
+
+void GAEngine::evaluatePopulation(Island& island) {
+  // Every member was scored by the population when it was created; reading
+  // the values back here is what used to be a second full evaluation.
+  const Population& population = *island.population;
+  island.scoreLookups += population.size();
+
+  // Best-so-far is updated in population order, so ties resolve the same way
+  // for any thread count.
+  for (size_t i = 0; i < population.size(); ++i) {
+    if (population.fitness(i) > island.bestFitness) {
+      Chromosome best = population.chromosome(i);
+      std::lock_guard<std::mutex> lock(bestMutex_);
+      island.bestFitness = population.fitness(i);
+      island.best = std::move(best);
+    }
   }
+}
+
+void GAEngine::migrate() {
+  // Everyone picks emigrants before anyone receives, so a migrant moves one
+  // island per migration whatever the island order.
+  for (Island& island : islands_)
+    island.population->emigrants(migration_.migrants, island.outgoing, island.outgoingScores);
+
+  const size_t                          k = islands_.size();
+  std::uniform_int_distribution<size_t> other(0, k - 2);
+  for (size_t i = 0; i < k; ++i) {
+    size_t target = (i + 1) % k;
+    if (migration_.topology == MigrationTopology::RANDOM) {
+      target = other(rng_);
+      if (target >= i)
+        ++target;
+    }
+    islands_[target].population->immigrate(islands_[i].outgoing, islands_[i].outgoingScores,
+                                           migration_.migrants);
+    islandStats_[target].immigrants += migration_.migrants;
+  }
+}
 
-  const auto& chromosomes = population_->getChromosomes();
+void GAEngine::collectBest() {
+  std::lock_guard<std::mutex> lock(bestMutex_);
+  for (const Island& island : islands_) {
+    if (island.bestFitness > bestFitness_) {
+      bestFitness_ = island.bestFitness;
+      best_ = island.best;
+    }
+  }
+}
+
+Chromosome GAEngine::bestSoFar() const {
+  std::lock_guard<std::mutex> lock(bestMutex_);
+  const Chromosome*           best = &best_;
+  double                      bestFitness = bestFitness_;
+  for (const Island& island : islands_) {
+    if (island.bestFitness > bestFitness) {
+      bestFitness = island.bestFitness;
+      best = &island.best;
+    }
+  }
+  return *best;
+}
+
+StopReason GAEngine::checkStop(size_t first, size_t end, double seconds) {
+  if (bestFitness_ > plateauFitness_ + stopping_.minImprovement) {
+    plateauFitness_ = bestFitness_;
+    plateauStart_ = end;
+  }
 
-  for (size_t i = 0; i < chromosomes.size(); ++i) {
-    double fitness = fitness_->evaluate(chromosomes[i]);
-    if (fitness > bestFitness_) {
-      bestFitness_ = fitness;
-      best_ = chromosomes[i];
+  // Validation runs at multiples of the interval, so on the same generations
+  // whether or not the run was resumed.
+  const size_t interval = stopping_.validationInterval;
+  if (stopping_.validation && end / interval > first / interval) {
+    std::vector<const double*> rows = {best_.genes.data()};
+    std::vector<double>        scores;
+    stopping_.validation->evaluateBatch(rows, scores);
+    std::cout << "Generation " << end - 1 << " | Validation Fitness: " << scores[0] << "\n";
+    if (scores[0] > bestValidation_) {
+      bestValidation_ = scores[0];
+      staleValidations_ = 0;
+    } else {
+      ++staleValidations_;
     }
   }
+
+  if (bestFitness_ >= stopping_.targetFitness)
+    return StopReason::TARGET;
+  if (stopping_.validation && staleValidations_ >= stopping_.validationPatience)
+    return StopReason::VALIDATION;
+  if (stopping_.stagnationGenerations > 0 &&
+      end - plateauStart_ >= stopping_.stagnationGenerations)
+    return StopReason::STAGNATION;
+  if (stopping_.maxSeconds > 0.0 && seconds >= stopping_.maxSeconds)
+    return StopReason::TIME_LIMIT;
+  return StopReason::GENERATIONS;
 }
 
 void GAEngine::run() {
-  if (!fitness_ || !population_) {
+  if (islands_.empty()) {
     throw std::runtime_error("Fitness evaluator not set. Call setFitnessEvaluator first.");
   }
 
-  std::cout << "Initializing population...\n";
-  population_->initialize();
+  const size_t k = islands_.size();
+  ThreadPool   pool(k);
+  const auto   runStart = std::chrono::steady_clock::now();
+
+  size_t start = 0;
+  if (!resumePath_.empty()) {
+    start = loadCheckpoint(resumePath_);
+    std::cout << "Resumed from " << resumePath_ << " at generation " << start
+              << " (random seed " << seed_ << ")\n";
+    resumePath_.clear();
+  } else {
+    // Streams are handed out in island order, so each island's draws depend
+    // on the seed alone.
+    Rng root(seed_);
+    for (Island& island : islands_)
+      island.population->setRng(root.fork());
+    rng_ = root.fork();
+    plateauFitness_ = bestValidation_ = -std::numeric_limits<double>::infinity();
+    plateauStart_ = staleValidations_ = 0;
+
+    std::cout << "Random seed: " << seed_ << "\n";
+    std::cout << "Initializing population...\n";
+    pool.parallelFor(k, [&](size_t i, size_t) { islands_[i].population->initialize(); });
+  }
+
+  if (k > 1) {
+    std::cout << "Starting GA evolution on " << k << " islands (migrating "
+              << migration_.migrants << " every " << migration_.interval << " generations, "
+              << (migration_.topology == MigrationTopology::RING ? "ring" : "random")
+              << " topology)...\n";
+  } else {
+    std::cout << "Starting GA evolution...\n";
+  }
 
-  std::cout << "Starting GA evolution...\n";
+  // Islands evolve independently for a whole epoch, then exchange migrants.
+  // A single population has nothing to exchange and reports every generation.
+  const size_t epoch = k > 1 ? migration_.interval : 1;
+  auto         lastCheckpoint = std::chrono::steady_clock::now();
+  size_t       lastCheckpointGeneration = start;
+  stopReason_ = StopReason::GENERATIONS;
+  generationsRun_ = start;
+  for (size_t first = start; first < generations_ && stopReason_ == StopReason::GENERATIONS;
+       first += epoch) {
+    const size_t end = std::min(generations_, first + epoch);
 
-  for (size_t generation = 0; generation < generations_; ++generation) {
-    evaluatePopulation();
+    pool.parallelFor(k, [&](size_t i, size_t) {
+      Island& island = islands_[i];
+      auto    start = std::chrono::steady_clock::now();
+      for (size_t generation = first; generation < end; ++generation) {
+        evaluatePopulation(island);
 
 #ifdef GA_TEST_MODE
-    std::cout << "\n=== Generation " << generation << " ===\n";
-    population_->debugPrint();
+        std::cout << "\n=== Generation " << generation << " ===\n";
+        island.population->debugPrint();
 #endif
 
-    if (generation < generations_ - 1) {
-      population_->evolve();
+        if (generation < generations_ - 1) {
+          island.population->evolve();
+        }
+        ++islandStats_[i].generations;
+      }
+      islandStats_[i].seconds +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    collectBest();
+    generationsRun_ = end;
+    if (end < generations_) {
+      auto now = std::chrono::steady_clock::now();
+      stopReason_ = checkStop(first, end, std::chrono::duration<double>(now - runStart).count());
+    }
+
+    // The population stopped at has been bred but not yet looked at.
+    if (stopReason_ != StopReason::GENERATIONS) {
+      pool.parallelFor(k, [&](size_t i, size_t) { evaluatePopulation(islands_[i]); });
+      collectBest();
+    } else if (k > 1 && end < generations_) {
+      migrate();
+    }
+
+    // Only between generations: the last one is scored but never evolved.
+    if (!checkpoint_.path.empty() && end < generations_ &&
+        stopReason_ == StopReason::GENERATIONS) {
+      auto   now = std::chrono::steady_clock::now();
+      double elapsed = std::chrono::duration<double>(now - lastCheckpoint).count();
+      if ((checkpoint_.generations > 0 &&
+           end - lastCheckpointGeneration >= checkpoint_.generations) ||
+          (checkpoint_.seconds > 0.0 && elapsed >= checkpoint_.seconds)) {
+        saveCheckpoint(end);
+        lastCheckpoint = now;
+        lastCheckpointGeneration = end;
+      }
     }
 
-    if (generation % 10 == 0 || generation == generations_ - 1) {
-      std::cout << "Generation " << generation << " | Best Fitness: " << bestFitness_ << "\n";
+    bool report = end == generations_ || stopReason_ != StopReason::GENERATIONS;
+    for (size_t generation = first; generation < end; ++generation)
+      report = report || generation % 10 == 0;
+    if (report) {
+      std::cout << "Generation " << end - 1 << " | Best Fitness: " << bestFitness_;
+      if (adaptive_.enabled) {
+        // Averaged over islands.
+        double crossover = 0.0, mutation = 0.0, step = 0.0;
+        for (const Island& island : islands_) {
+          crossover += island.population->crossoverProb() / static_cast<double>(k);
+          mutation += island.population->mutationProb() / static_cast<double>(k);
+          step += island.population->mutationStep() / static_cast<double>(k);
+        }
+        std::cout << " | Crossover " << crossover << ", Mutation " << mutation << ", Step "
+                  << step;
+      }
+      std::cout << "\n";
     }
   }
 
-  std::cout << "\nGA Complete\n";
+  for (size_t i = 0; i < k; ++i) {
+    const Population& population = *islands_[i].population;
+    IslandStats&      stats = islandStats_[i];
+    stats.size = population.size();
+    stats.bestFitness = islands_[i].bestFitness;
+    stats.meanFitness = 0.0;
+    for (size_t m = 0; m < population.size(); ++m)
+      stats.meanFitness += population.fitness(m) / static_cast<double>(population.size());
+    stats.evaluations = population.evaluationStats();
+    stats.evaluations.requested += islands_[i].scoreLookups;
+    stats.evaluations.inherited += islands_[i].scoreLookups;
+  }
+
+  std::cout << "\nGA Complete after " << generationsRun_ << " generations: ";
+  switch (stopReason_) {
+  case StopReason::GENERATIONS:
+    std::cout << "generation limit reached\n";
+    break;
+  case StopReason::STAGNATION:
+    std::cout << "best fitness rose by at most " << stopping_.minImprovement << " in "
+              << stopping_.stagnationGenerations << " generations\n";
+    break;
+  case StopReason::TARGET:
+    std::cout << "target fitness " << stopping_.targetFitness << " reached\n";
+    break;
+  case StopReason::TIME_LIMIT:
+    std::cout << "time limit of " << stopping_.maxSeconds << " s reached\n";
+    break;
+  case StopReason::VALIDATION:
+    std::cout << "validation fitness stopped improving (best " << bestValidation_ << ")\n";
+    break;
+  }
   std::cout << "Final Best Fitness: " << bestFitness_ << "\n";
+
+  EvaluationStats stats = evaluationStats();
+  std::cout << "Fitness evaluations: " << stats.evaluated << " of " << stats.requested << " ("
+            << stats.requested - stats.evaluated << " saved: " << stats.inherited
+            << " already scored, " << stats.clones << " clones)\n";
+
+  if (k > 1) {
+    std::cout << "\nIsland  Size  Best      Mean      Evaluated  Immigrants  Gen/s\n";
+    for (size_t i = 0; i < k; ++i) {
+      const IslandStats& s = islandStats_[i];
+      std::cout << std::setw(6) << i << std::setw(6) << s.size << std::fixed
+                << std::setprecision(4) << std::setw(10) << s.bestFitness << std::setw(10)
+                << s.meanFitness << std::setw(11) << s.evaluations.evaluated << std::setw(12)
+                << s.immigrants << std::setprecision(1) << std::setw(7)
+                << (s.seconds > 0.0 ? s.generations / s.seconds : 0.0) << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+  }
+}
+
+void GAEngine::saveCheckpoint(size_t generation) const {
+  CheckpointWriter out(checkpoint_.path);
+  out.put(uint64_t(TOTAL_GENES));
+  out.put(uint64_t(populationSize_));
+  out.put(uint64_t(islands_.size()));
+  out.put(uint64_t(migration_.interval));
+  out.put(uint64_t(migration_.migrants));
+  out.put(uint32_t(migration_.topology));
+  out.put(seed_);
+  out.put(uint64_t(generation));
+  out.put(rng_.state());
+  out.put(bestFitness_);
+  saveChromosome(out, best_);
+  out.put(plateauFitness_);
+  out.put(uint64_t(plateauStart_));
+  out.put(bestValidation_);
+  out.put(uint64_t(staleValidations_));
+
+  for (size_t i = 0; i < islands_.size(); ++i) {
+    const Island&      island = islands_[i];
+    const IslandStats& stats = islandStats_[i];
+    out.put(island.bestFitness);
+    saveChromosome(out, island.best);
+    out.put(uint64_t(island.scoreLookups));
+    out.put(uint64_t(stats.generations));
+    out.put(uint64_t(stats.immigrants));
+    out.put(stats.seconds);
+    island.population->save(out);
+  }
+  out.commit();
+}
+
+size_t GAEngine::loadCheckpoint(const std::string& path) {
+  CheckpointReader in(path);
+  if (in.get<uint64_t>() != TOTAL_GENES)
+    in.mismatch("gene count differs");
+  if (in.get<uint64_t>() != populationSize_)
+    in.mismatch("population size differs");
+  if (in.get<uint64_t>() != islands_.size())
+    in.mismatch("island count differs");
+  const uint64_t interval = in.get<uint64_t>();
+  const uint64_t migrants = in.get<uint64_t>();
+  const uint32_t topology = in.get<uint32_t>();
+  if (islands_.size() > 1 &&
+      (interval != migration_.interval || migrants != migration_.migrants ||
+       topology != uint32_t(migration_.topology)))
+    in.mismatch("migration policy differs");
+
+  seed_ = in.get<uint64_t>();
+  const size_t generation = in.get<uint64_t>();
+  if (generation >= generations_)
+    in.mismatch("it is already at generation " + std::to_string(generation) + " of " +
+                std::to_string(generations_));
+  rng_.setState(in.get<Rng::State>());
+  bestFitness_ = in.get<double>();
+  loadChromosome(in, best_);
+  plateauFitness_ = in.get<double>();
+  plateauStart_ = in.get<uint64_t>();
+  bestValidation_ = in.get<double>();
+  staleValidations_ = in.get<uint64_t>();
+
+  for (size_t i = 0; i < islands_.size(); ++i) {
+    Island&      island = islands_[i];
+    IslandStats& stats = islandStats_[i];
+    island.bestFitness = in.get<double>();
+    loadChromosome(in, island.best);
+    island.scoreLookups = in.get<uint64_t>();
+    stats.generations = in.get<uint64_t>();
+    stats.immigrants = in.get<uint64_t>();
+    stats.seconds = in.get<double>();
+    island.population->load(in);
+  }
+
+  // Scores are carried over, not recomputed: one rescored chromosome catches
+  // evaluators that differ from the ones that wrote the checkpoint.
+  std::vector<const double*> rows = {best_.genes.data()};
+  std::vector<double>        rescored;
+  islands_[0].fitness->evaluateBatch(rows, rescored);
+  if (rescored[0] != bestFitness_)
+    in.mismatch("the training data or inference mode differs");
+  return generation;
+}
+
+EvaluationStats GAEngine::evaluationStats() const {
+  EvaluationStats stats;
+  for (const Island& island : islands_) {
+    const EvaluationStats& own = island.population->evaluationStats();
+    stats.requested += own.requested + island.scoreLookups;
+    stats.evaluated += own.evaluated;
+    stats.inherited += own.inherited + island.scoreLookups;
+    stats.clones += own.clones;
+  }
+  return stats;
 }
 } // namespace ga
@@ -1,37 +1,186 @@
 #pragma once
 #include "Chromosome.hpp"
 #include "Fitness.hpp"
+#include "GeneMatrix.hpp"
 #include "Population.hpp"
+#include "Rng.hpp"
 #include "ga_config.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace ga {
 
+enum class MigrationTopology {
+  RING,  // island i sends to island i + 1
+  RANDOM // each island sends to another picked at random, anew every migration
+};
+
+// Every `interval` generations each island sends copies of its `migrants`
+// fittest members to another island, where they replace the least fit.
+struct MigrationPolicy {
+  size_t            interval = 10;
+  size_t            migrants = 2;
+  MigrationTopology topology = MigrationTopology::RING;
+};
+
+// One island's share of a run, read after run().
+struct IslandStats {
+  size_t          size = 0;        // members
+  size_t          generations = 0; // generations evolved
+  double          bestFitness = 0.0;
+  double          meanFitness = 0.0; // over the final population
+  size_t          immigrants = 0;
+  double          seconds = 0.0; // wall time spent evolving on the island's thread
+  EvaluationStats evaluations;
+};
+
+// Where and how often run() saves its state. A checkpoint is written at the end
+// of an epoch once `generations` generations, or `seconds` of wall time, have
+// passed since the last one; 0 turns either trigger off.
+struct CheckpointPolicy {
+  std::string path; // empty: no checkpoints
+  size_t      generations = 10;
+  double      seconds = 0.0;
+};
+
+// Conditions that end run() before all its generations, checked between
+// epochs. Every criterion is off by default.
+struct StoppingCriteria {
+  // Stop once the best fitness has risen by no more than `minImprovement`
+  // over this many generations.
+  size_t stagnationGenerations = 0;
+  double minImprovement = 0.0;
+
+  double targetFitness = std::numeric_limits<double>::infinity();
+  double maxSeconds = 0.0; // wall-clock budget of one run() call
+
+  // Every `validationInterval` generations the best chromosome is scored by
+  // this held-out evaluator; stop after `validationPatience` checks in a row
+  // without a new best validation fitness.
+  Fitness* validation = nullptr;
+  size_t   validationInterval = 10;
+  size_t   validationPatience = 3;
+};
+
+enum class StopReason {
+  GENERATIONS, // ran them all
+  STAGNATION,
+  TARGET,
+  TIME_LIMIT,
+  VALIDATION
+};
+
 class GAEngine {
 public:
   GAEngine(size_t populationSize = 100, size_t generations = 100, double crossoverProb = 0.8,
            double mutationProb = 0.2, size_t tournamentSize = 3);
 
+  // A single panmictic population scored by `fitness`.
   void setFitnessEvaluator(Fitness* fitness);
+
+  // Island model: one island per evaluator, each evolving its share of the
+  // population on its own thread and scoring with its own evaluator, so
+  // evaluators must agree (same samples, same inference mode). Islands only
+  // meet at migrations, which run between epochs of `migration.interval`
+  // generations, so the outcome does not depend on thread timing.
+  void setIslands(const std::vector<Fitness*>& evaluators, const MigrationPolicy& migration = {});
+
+  // Seed of every random stream in a run: each island breeds from its own
+  // stream and migration draws from another, all split off this seed, so a
+  // run is reproduced by its seed whatever the thread count. Defaults to a
+  // fresh random seed, which run() prints.
+  void     setSeed(uint64_t seed) { seed_ = seed; }
+  uint64_t seed() const { return seed_; }
+
+  void setCheckpoints(const CheckpointPolicy& policy) { checkpoint_ = policy; }
+
+  // Makes the next run() continue from a checkpoint instead of starting anew,
+  // with the same result as if it had never stopped. Islands, migration policy
+  // and population size must be as when it was written, and the evaluators
+  // must score the same samples the same way; the seed comes from the
+  // checkpoint. run() throws std::runtime_error if the checkpoint does not fit.
+  void resumeFrom(const std::string& path) { resumePath_ = path; }
+
+  void setStoppingCriteria(const StoppingCriteria& criteria);
+
+  // Lets every island adapt its crossover and mutation rates and mutation
+  // step, starting from the constructor's rates (see AdaptiveVariation).
+  void setAdaptiveVariation(const AdaptiveVariation& adaptive);
+
   void run();
 
+  // Why the last run() ended, and after how many generations in total.
+  StopReason stopReason() const { return stopReason_; }
+  size_t     generationsRun() const { return generationsRun_; }
+
   const Chromosome& bestChromosome() const { return best_; }
   double            bestFitness() const { return bestFitness_; }
 
+  // Fittest chromosome found so far on any island; may be called from another
+  // thread while run() is executing.
+  Chromosome bestSoFar() const;
+
+  // Fitness values needed so far, counting the engine's per-generation pass
+  // over the survivors, and how many were actually computed.
+  EvaluationStats evaluationStats() const;
+
+  const std::vector<IslandStats>& islandStats() const { return islandStats_; }
+
 private:
-  size_t populationSize_;
-  size_t generations_;
-  double crossoverProb_;
-  double mutationProb_;
-  size_t tournamentSize_;
-
-  Fitness*                    fitness_;
-  std::unique_ptr<Population> population_;
-  Chromosome                  best_;
-  double                      bestFitness_;
-
-  void evaluatePopulation();
+  size_t   populationSize_;
+  size_t   generations_;
+  double   crossoverProb_;
+  double   mutationProb_;
+  size_t   tournamentSize_;
+  uint64_t seed_;
+
+  struct Island {
+    Fitness*                    fitness;
+    std::unique_ptr<Population> population;
+    Chromosome                  best;
+    double                      bestFitness;
+    size_t                      scoreLookups = 0;
+    GeneMatrix                  outgoing; // emigrants of the current migration
+    std::vector<double>         outgoingScores;
+  };
+
+  std::vector<Island>      islands_;
+  std::vector<IslandStats> islandStats_;
+  MigrationPolicy          migration_;
+  Rng                      rng_; // picks RANDOM migration targets
+  CheckpointPolicy         checkpoint_;
+  std::string              resumePath_;
+  StoppingCriteria         stopping_;
+  AdaptiveVariation        adaptive_;
+  StopReason               stopReason_ = StopReason::GENERATIONS;
+  size_t                   generationsRun_ = 0;
+
+  // Progress of the stopping criteria; part of a checkpoint.
+  double plateauFitness_ = -std::numeric_limits<double>::infinity(); // when the plateau began
+  size_t plateauStart_ = 0; // generation it began
+  double bestValidation_ = -std::numeric_limits<double>::infinity();
+  size_t staleValidations_ = 0; // checks since bestValidation_ last rose
+
+  mutable std::mutex bestMutex_; // guards the islands' best and bestFitness
+  Chromosome         best_;
+  double             bestFitness_;
+
+  void evaluatePopulation(Island& island);
+  void migrate();
+  void collectBest();
+
+  // Checks the stopping criteria after generations [first, end); GENERATIONS
+  // means carry on.
+  StopReason checkStop(size_t first, size_t end, double seconds);
+
+  // `generation` is the first one the checkpoint has still to run.
+  void   saveCheckpoint(size_t generation) const;
+  size_t loadCheckpoint(const std::string& path);
 };
 } // namespace ga
@@ -0,0 +1,50 @@
+#pragma once
+#include "Chromosome.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace ga {
+
+// Genes of many chromosomes in one contiguous block, a row of TOTAL_GENES per
+// chromosome. Rows are padded to a whole number of cache lines and the block
+// is cache-line aligned, so every row starts on its own line.
+class GeneMatrix {
+public:
+  static constexpr size_t ALIGNMENT = 64;
+  static constexpr size_t STRIDE =
+      (TOTAL_GENES * sizeof(double) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT / sizeof(double);
+
+  GeneMatrix() = default;
+  explicit GeneMatrix(size_t rows) { resize(rows); }
+
+  // Contents are not preserved.
+  void resize(size_t rows) {
+    data_.reset(rows ? static_cast<double*>(::operator new(rows * STRIDE * sizeof(double),
+                                                           std::align_val_t(ALIGNMENT)))
+                     : nullptr);
+    if (rows)
+      std::memset(data_.get(), 0, rows * STRIDE * sizeof(double));
+    rows_ = rows;
+  }
+
+  size_t rows() const { return rows_; }
+
+  double*       row(size_t r) { return data_.get() + r * STRIDE; }
+  const double* row(size_t r) const { return data_.get() + r * STRIDE; }
+
+  void copyRow(size_t to, const GeneMatrix& from, size_t r) {
+    std::memcpy(row(to), from.row(r), TOTAL_GENES * sizeof(double));
+  }
+
+private:
+  struct AlignedDelete {
+    void operator()(double* p) const { ::operator delete(p, std::align_val_t(ALIGNMENT)); }
+  };
+
+  std::unique_ptr<double, AlignedDelete> data_;
+  size_t                                 rows_ = 0;
+};
+} // namespace ga
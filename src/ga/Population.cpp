@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 
@@ -11,129 +13,389 @@ namespace ga {
 Population::Population(size_t populationSize, Fitness& fitnessEvaluator, double crossoverProb,
                        double mutationProb, size_t tournamentSize)
     : populationSize_(populationSize), fitness_(fitnessEvaluator), crossoverProb_(crossoverProb),
-      mutationProb_(mutationProb), tournamentSize_(tournamentSize) {
+      mutationProb_(mutationProb), tournamentSize_(tournamentSize),
+      initialCrossoverProb_(crossoverProb), initialMutationProb_(mutationProb) {
   if (populationSize_ == 0)
     throw std::runtime_error("Population size must be > 0");
+
+  const size_t rows = 2 * populationSize_;
+  members_.resize(rows);
+  scores_.assign(rows, 0.0);
+  scored_.assign(rows, 0);
+  spare_.resize(rows);
+  spareScores_.assign(rows, 0.0);
+  spareScored_.assign(rows, 0);
+  order_.resize(rows);
+  parent_.resize(populationSize_);
+  varied_.resize(populationSize_);
+
+  // Room for several generations' worth of new rows, and a table at most half
+  // full so probes stay short.
+  const size_t memoRows = std::max(MEMO_MIN_ROWS, 2 * rows);
+  size_t       slots = 1;
+  while (slots < 2 * memoRows)
+    slots <<= 1;
+  memoGenes_.resize(memoRows);
+  memoFitness_.assign(memoRows, 0.0);
+  memoBatch_.assign(memoRows, NONE);
+  memoHash_.assign(slots, 0);
+  memoRow_.assign(slots, NONE);
+
+  batch_.reserve(rows);
+  batchMemo_.reserve(rows);
+  slot_.resize(rows);
+  results_.reserve(rows);
 }
 
-void Population::initialize() {
-  chromosomes_.resize(populationSize_);
-  fitnessValues_.resize(populationSize_);
+void Population::setAdaptiveVariation(const AdaptiveVariation& adaptive) {
+  if (adaptive.enabled && (adaptive.step <= 0.0 || adaptive.factor <= 1.0))
+    throw std::runtime_error("Adaptive variation needs step > 0 and factor > 1");
+  adaptive_ = adaptive;
+  crossoverProb_ = initialCrossoverProb_;
+  mutationProb_ = initialMutationProb_;
+  step_ = adaptive.enabled ? adaptive.step : 0.0;
+}
 
-  for (auto& c : chromosomes_) {
-    c = Chromosome();
-    c.mutate(0.9);
+void Population::initialize() {
+  GeneBounds bounds[TOTAL_GENES];
+  for (size_t i = 0; i < populationSize_; ++i) {
+    double* row = members_.row(i);
+    std::copy(Chromosome::DEFAULT_GENES.begin(), Chromosome::DEFAULT_GENES.end(), row);
+    updateRowBounds(row, bounds);
+    repairRow(row, bounds);
+    mutateRow(row, bounds, 0.9, rng_);
+    scored_[i] = 0;
   }
 
-  evaluateFitness();
+  evaluateFitness(populationSize_);
 }
 
 void Population::debugPrint() const {
 #ifdef GA_TEST_MODE
-  for (size_t i = 0; i < chromosomes_.size(); ++i) {
-    std::cout << "Ind " << i << " | Fitness: " << fitnessValues_[i] << " | ";
-    for (double g : chromosomes_[i].genes)
-      std::cout << g << " ";
+  for (size_t i = 0; i < populationSize_; ++i) {
+    std::cout << "Ind " << i << " | Fitness: " << scores_[i] << " | ";
+    for (size_t g = 0; g < TOTAL_GENES; ++g)
+      std::cout << members_.row(i)[g] << " ";
     std::cout << "\n";
   }
 #endif
 }
 
-void Population::evaluateFitness() {
-  assert(!chromosomes_.empty());
-  assert(chromosomes_.size() == fitnessValues_.size());
+size_t Population::findMemo(uint64_t hash, const double* genes) const {
+  const size_t mask = memoRow_.size() - 1;
+  for (size_t s = hash & mask; memoRow_[s] != NONE; s = (s + 1) & mask) {
+    if (memoHash_[s] == hash &&
+        std::memcmp(memoGenes_.row(memoRow_[s]), genes, TOTAL_GENES * sizeof(double)) == 0)
+      return memoRow_[s];
+  }
+  return NONE;
+}
+
+size_t Population::insertMemo(uint64_t hash, const double* genes) {
+  const size_t mask = memoRow_.size() - 1;
+  size_t       s = hash & mask;
+  while (memoRow_[s] != NONE)
+    s = (s + 1) & mask;
+
+  const size_t row = memoUsed_++;
+  std::memcpy(memoGenes_.row(row), genes, TOTAL_GENES * sizeof(double));
+  memoHash_[s] = hash;
+  memoRow_[s] = row;
+  return row;
+}
+
+void Population::clearMemo() {
+  std::fill(memoRow_.begin(), memoRow_.end(), NONE);
+  memoUsed_ = 0;
+}
 
-  for (size_t i = 0; i < chromosomes_.size(); ++i) {
-    fitnessValues_[i] = fitness_.evaluate(chromosomes_[i]);
+void Population::evaluateFitness(size_t rows) {
+  assert(rows <= members_.rows());
 
-    assert(fitnessValues_[i] >= 0.0);
+  // Every row of this call fits, so no entry is dropped while its batch is
+  // being scored.
+  if (memoUsed_ + rows > memoGenes_.rows())
+    clearMemo();
+
+  // Parents and unchanged offspring keep their score; a clone of a chromosome
+  // scored earlier takes it from the memo; clones within this batch are
+  // scored once.
+  batch_.clear();
+  batchMemo_.clear();
+  for (size_t i = 0; i < rows; ++i) {
+    slot_[i] = NONE;
+    ++stats_.requested;
+    if (scored_[i]) {
+      ++stats_.inherited;
+      continue;
+    }
+
+    const double* row = members_.row(i);
+    uint64_t      h = hashGenes(row, TOTAL_GENES);
+    size_t        m = findMemo(h, row);
+    if (m != NONE) {
+      if (memoBatch_[m] == NONE) {
+        scores_[i] = memoFitness_[m];
+        scored_[i] = 1;
+      } else {
+        slot_[i] = memoBatch_[m];
+      }
+      ++stats_.clones;
+      continue;
+    }
+
+    m = insertMemo(h, row);
+    memoBatch_[m] = batch_.size();
+    slot_[i] = batch_.size();
+    batch_.push_back(row);
+    batchMemo_.push_back(m);
+  }
+
+  if (!batch_.empty())
+    fitness_.evaluateBatch(batch_, results_);
+  stats_.evaluated += batch_.size();
+
+  for (size_t b = 0; b < batch_.size(); ++b) {
+    memoFitness_[batchMemo_[b]] = results_[b];
+    memoBatch_[batchMemo_[b]] = NONE;
+  }
+
+  for (size_t i = 0; i < rows; ++i) {
+    if (slot_[i] != NONE) {
+      scores_[i] = results_[slot_[i]];
+      scored_[i] = 1;
+    }
+    assert(scores_[i] >= 0.0);
   }
 }
 
-Chromosome Population::tournamentSelect() {
-  static std::random_device             rd;
-  static std::mt19937                   gen(rd());
+size_t Population::tournamentSelect() {
   std::uniform_int_distribution<size_t> dis(0, populationSize_ - 1);
 
-  size_t bestIdx = dis(gen);
-  double bestFit = fitnessValues_[bestIdx];
+  size_t bestIdx = dis(rng_);
+  double bestFit = scores_[bestIdx];
 
   for (size_t i = 1; i < tournamentSize_; ++i) {
-    size_t idx = dis(gen);
-    if (fitnessValues_[idx] > bestFit) {
+    size_t idx = dis(rng_);
+    if (scores_[idx] > bestFit) {
       bestIdx = idx;
-      bestFit = fitnessValues_[idx];
+      bestFit = scores_[idx];
     }
   }
 
-  return chromosomes_[bestIdx];
+  return bestIdx;
 }
 
-void Population::evolve() {
-  std::vector<Chromosome> offspringPopulation;
-  offspringPopulation.reserve(populationSize_);
+void Population::mutateOffspring(double* row, const GeneBounds* bounds) {
+  if (adaptive_.enabled)
+    gaussianMutateRow(row, bounds, Chromosome::DEFAULT_MUTATION_RATE, step_, rng_);
+  else
+    mutateRow(row, bounds, Chromosome::DEFAULT_MUTATION_RATE, rng_);
+}
 
-  static std::random_device              rd;
-  static std::mt19937                    gen(rd());
+void Population::adaptVariation() {
+  const size_t n = populationSize_;
+  size_t       crossed = 0, crossedWon = 0, mutated = 0, mutatedWon = 0;
+  for (size_t k = 0; k < n; ++k) {
+    const bool won = scores_[n + k] > scores_[parent_[k]];
+    if (varied_[k] & CROSSED) {
+      ++crossed;
+      crossedWon += won;
+    }
+    if (varied_[k] & MUTATED) {
+      ++mutated;
+      mutatedWon += won;
+    }
+  }
+
+  auto adapt = [this](double& value, size_t tried, size_t won, double lo, double hi) {
+    if (tried == 0)
+      return;
+    if (static_cast<double>(won) > TARGET_SUCCESS * static_cast<double>(tried))
+      value = std::min(hi, value * adaptive_.factor);
+    else
+      value = std::max(lo, value / adaptive_.factor);
+  };
+  adapt(crossoverProb_, crossed, crossedWon, MIN_RATE, 1.0);
+  adapt(mutationProb_, mutated, mutatedWon, MIN_RATE, 1.0);
+  adapt(step_, mutated, mutatedWon, MIN_STEP, MAX_STEP);
+}
+
+void Population::evolve() {
   std::uniform_real_distribution<double> probDist(0.0, 1.0);
+  const size_t                           n = populationSize_;
+
+  GeneBounds bounds[TOTAL_GENES];
+  double     discarded[TOTAL_GENES]; // second child of the last pair when n is odd
 
-  while (offspringPopulation.size() < populationSize_) {
-    Chromosome parent1 = tournamentSelect();
-    Chromosome parent2 = tournamentSelect();
+  for (size_t k = 0; k < n; k += 2) {
+    const size_t parent1 = tournamentSelect();
+    const size_t parent2 = tournamentSelect();
+    const bool   paired = k + 1 < n;
 
-    Chromosome offspring1 = parent1;
-    Chromosome offspring2 = parent2;
+    double* offspring1 = members_.row(n + k);
+    double* offspring2 = paired ? members_.row(n + k + 1) : discarded;
+    std::memcpy(offspring1, members_.row(parent1), TOTAL_GENES * sizeof(double));
+    std::memcpy(offspring2, members_.row(parent2), TOTAL_GENES * sizeof(double));
+    bool changed1 = false, changed2 = false;
 
     // Crossover
-    if (probDist(gen) < crossoverProb_) {
-      Chromosome::crossover(parent1, parent2, offspring1, offspring2);
+    if (probDist(rng_) < crossoverProb_) {
+      crossoverRows(offspring1, offspring2, rng_);
+      updateRowBounds(offspring1, bounds);
+      repairRow(offspring1, bounds);
+      updateRowBounds(offspring2, bounds);
+      repairRow(offspring2, bounds);
+      changed1 = changed2 = true;
+      varied_[k] = CROSSED;
+      if (paired)
+        varied_[k + 1] = CROSSED;
+    } else {
+      varied_[k] = 0;
+      if (paired)
+        varied_[k + 1] = 0;
     }
 
     // Mutation
-    if (probDist(gen) < mutationProb_)
-      offspring1.mutate();
-    if (probDist(gen) < mutationProb_)
-      offspring2.mutate();
-
-    offspringPopulation.push_back(offspring1);
-    if (offspringPopulation.size() < populationSize_)
-      offspringPopulation.push_back(offspring2);
+    if (probDist(rng_) < mutationProb_) {
+      updateRowBounds(offspring1, bounds);
+      mutateOffspring(offspring1, bounds);
+      changed1 = true;
+      varied_[k] |= MUTATED;
+    }
+    if (probDist(rng_) < mutationProb_) {
+      updateRowBounds(offspring2, bounds);
+      mutateOffspring(offspring2, bounds);
+      changed2 = true;
+      if (paired)
+        varied_[k + 1] |= MUTATED;
+    }
+
+    parent_[k] = parent1;
+    if (paired)
+      parent_[k + 1] = parent2;
+
+    scored_[n + k] = !changed1 && scored_[parent1];
+    scores_[n + k] = scores_[parent1];
+    if (paired) {
+      scored_[n + k + 1] = !changed2 && scored_[parent2];
+      scores_[n + k + 1] = scores_[parent2];
+    }
+  }
+
+  evaluateFitness(2 * n);
+  if (adaptive_.enabled)
+    adaptVariation();
+
+  std::iota(order_.begin(), order_.end(), 0);
+  std::sort(order_.begin(), order_.end(),
+            [this](size_t a, size_t b) { return scores_[a] > scores_[b]; });
+
+  for (size_t i = 0; i < n; ++i) {
+    spare_.copyRow(i, members_, order_[i]);
+    spareScores_[i] = scores_[order_[i]];
+    spareScored_[i] = scored_[order_[i]];
+  }
+
+  std::swap(members_, spare_);
+  scores_.swap(spareScores_);
+  scored_.swap(spareScored_);
+}
+
+void Population::emigrants(size_t count, GeneMatrix& out, std::vector<double>& scores) {
+  count = std::min(count, populationSize_);
+  auto members = order_.begin() + static_cast<std::ptrdiff_t>(populationSize_);
+  std::iota(order_.begin(), members, 0);
+  std::partial_sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(count), members,
+                    [this](size_t a, size_t b) { return scores_[a] > scores_[b]; });
+
+  for (size_t i = 0; i < count; ++i) {
+    out.copyRow(i, members_, order_[i]);
+    scores[i] = scores_[order_[i]];
   }
+}
 
-  std::vector<Chromosome> combinedPopulation;
-  combinedPopulation.reserve(2 * populationSize_);
+void Population::immigrate(const GeneMatrix& in, const std::vector<double>& scores,
+                           size_t count) {
+  count = std::min(count, populationSize_);
+  auto members = order_.begin() + static_cast<std::ptrdiff_t>(populationSize_);
+  std::iota(order_.begin(), members, 0);
+  std::partial_sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(count), members,
+                    [this](size_t a, size_t b) { return scores_[a] < scores_[b]; });
 
-  combinedPopulation.insert(combinedPopulation.end(), chromosomes_.begin(), chromosomes_.end());
-  combinedPopulation.insert(combinedPopulation.end(), offspringPopulation.begin(),
-                            offspringPopulation.end());
+  for (size_t i = 0; i < count; ++i) {
+    members_.copyRow(order_[i], in, i);
+    scores_[order_[i]] = scores[i];
+    scored_[order_[i]] = 1;
+  }
+}
 
-  chromosomes_ = std::move(combinedPopulation);
-  fitnessValues_.resize(chromosomes_.size());
-  evaluateFitness();
+void Population::save(CheckpointWriter& out) const {
+  out.put(uint64_t(populationSize_));
+  for (size_t i = 0; i < populationSize_; ++i)
+    out.putArray(members_.row(i), TOTAL_GENES);
+  out.putArray(scores_.data(), populationSize_);
+  out.putArray(scored_.data(), populationSize_);
+  out.put(rng_.state());
+  out.put(crossoverProb_);
+  out.put(mutationProb_);
+  out.put(step_);
 
-  std::vector<size_t> indices(chromosomes_.size());
-  std::iota(indices.begin(), indices.end(), 0);
+  const uint64_t counters[] = {stats_.requested, stats_.evaluated, stats_.inherited,
+                               stats_.clones};
+  out.put(counters);
 
-  std::sort(indices.begin(), indices.end(),
-            [this](size_t a, size_t b) { return fitnessValues_[a] > fitnessValues_[b]; });
+  // Memo rows only; the hash table is rebuilt from them on load.
+  out.put(uint64_t(memoUsed_));
+  for (size_t m = 0; m < memoUsed_; ++m)
+    out.putArray(memoGenes_.row(m), TOTAL_GENES);
+  out.putArray(memoFitness_.data(), memoUsed_);
+}
 
-  std::vector<Chromosome> elitePopulation;
-  std::vector<double>     eliteFitness;
-  elitePopulation.reserve(populationSize_);
-  eliteFitness.reserve(populationSize_);
+void Population::load(CheckpointReader& in) {
+  if (in.get<uint64_t>() != populationSize_)
+    in.mismatch("population size differs");
+  for (size_t i = 0; i < populationSize_; ++i)
+    in.getArray(members_.row(i), TOTAL_GENES);
+  in.getArray(scores_.data(), populationSize_);
+  in.getArray(scored_.data(), populationSize_);
+  rng_.setState(in.get<Rng::State>());
+  crossoverProb_ = in.get<double>();
+  mutationProb_ = in.get<double>();
+  step_ = in.get<double>();
 
-  for (size_t i = 0; i < populationSize_; ++i) {
-    elitePopulation.push_back(chromosomes_[indices[i]]);
-    eliteFitness.push_back(fitnessValues_[indices[i]]);
+  uint64_t counters[4];
+  in.getArray(counters, 4);
+  stats_.requested = counters[0];
+  stats_.evaluated = counters[1];
+  stats_.inherited = counters[2];
+  stats_.clones = counters[3];
+
+  // Re-inserting in row order reproduces the table exactly.
+  const uint64_t memoRows = in.get<uint64_t>();
+  if (memoRows > memoGenes_.rows())
+    in.mismatch("clone memo is larger than this population's");
+  clearMemo();
+  double genes[TOTAL_GENES];
+  for (size_t m = 0; m < memoRows; ++m) {
+    in.getArray(genes, TOTAL_GENES);
+    insertMemo(hashGenes(genes, TOTAL_GENES), genes);
   }
+  in.getArray(memoFitness_.data(), memoRows);
+  std::fill(memoBatch_.begin(), memoBatch_.end(), NONE);
+}
 
-  chromosomes_ = std::move(elitePopulation);
-  fitnessValues_ = std::move(eliteFitness);
+Chromosome Population::chromosome(size_t i) const {
+  Chromosome c;
+  std::copy(members_.row(i), members_.row(i) + TOTAL_GENES, c.genes.begin());
+  c.updateBounds();
+  c.fitness = scores_[i];
+  c.scored = scored_[i] != 0;
+  return c;
 }
 
 Chromosome Population::getBest() const {
-  auto   maxIt = std::max_element(fitnessValues_.begin(), fitnessValues_.end());
-  size_t idx = std::distance(fitnessValues_.begin(), maxIt);
-  return chromosomes_[idx];
+  auto idx = std::max_element(scores_.begin(), scores_.begin() + populationSize_) - scores_.begin();
+  return chromosome(static_cast<size_t>(idx));
 }
 } // namespace ga
@@ -1,24 +1,82 @@
 #pragma once
+#include "Checkpoint.hpp"
 #include "Chromosome.hpp"
 #include "Fitness.hpp"
+#include "GeneMatrix.hpp"
+#include "Rng.hpp"
 #include "ga_config.hpp"
 
-#include <memory>
+#include <cstdint>
 #include <vector>
 
 namespace ga {
 
+// Fitness values a Population needed and how each was obtained.
+struct EvaluationStats {
+  size_t requested = 0; // members needing a value, summed over evaluateFitness() calls
+  size_t evaluated = 0; // sent to Fitness
+  size_t inherited = 0; // already scored: carried over from the previous generation
+  size_t clones = 0;    // gene-for-gene copies of a chromosome scored earlier
+};
+
+// Success-rule control of variation (Rechenberg's 1/5 rule). Mutation moves
+// genes by a Gaussian step, a fraction of each gene's bound width, instead of
+// redrawing them uniformly. After every generation, crossover and mutation are
+// each applied more often when more than a fifth of the offspring they changed
+// beat their parent, and less often otherwise; the step follows the success of
+// mutated offspring the same way, so it shrinks as the search converges.
+struct AdaptiveVariation {
+  bool   enabled = false;
+  double step = 0.3;    // initial step
+  double factor = 1.22; // per-generation multiplier or divisor of rates and step
+};
+
+// Members live as rows of a gene matrix rather than as Chromosome objects.
+// Offspring are bred in place into rows after the parents, and the survivors
+// are gathered into a second matrix that then swaps in, so once constructed a
+// generation allocates nothing here (Fitness may, internally).
 class Population {
 public:
   Population(size_t populationSize, Fitness& fitnessEvaluator, double crossoverProb = 0.8,
              double mutationProb = 0.3, size_t tournamentSize = 3);
 
+  // Stream for initialization and breeding; by default every population
+  // starts from Rng's default seed.
+  void setRng(const Rng& rng) { rng_ = rng; }
+
+  // Starts adapting from the constructor's rates and `adaptive.step`.
+  void setAdaptiveVariation(const AdaptiveVariation& adaptive);
+
   void initialize();
   void evolve();
   void debugPrint() const;
 
-  Chromosome                     getBest() const;
-  const std::vector<Chromosome>& getChromosomes() const { return chromosomes_; }
+  size_t        size() const { return populationSize_; }
+  const double* genes(size_t i) const { return members_.row(i); }
+  double        fitness(size_t i) const { return scores_[i]; }
+
+  // Island migration. emigrants() copies the `count` fittest members into the
+  // first rows of `out`, best first, with their scores; immigrate() overwrites
+  // the `count` least fit members with rows of `in`, keeping the scores given.
+  void emigrants(size_t count, GeneMatrix& out, std::vector<double>& scores);
+  void immigrate(const GeneMatrix& in, const std::vector<double>& scores, size_t count);
+
+  // Copy of member i as a standalone chromosome.
+  Chromosome chromosome(size_t i) const;
+  Chromosome getBest() const;
+
+  const EvaluationStats& evaluationStats() const { return stats_; }
+
+  // Current operator settings; constant unless variation is adaptive.
+  double crossoverProb() const { return crossoverProb_; }
+  double mutationProb() const { return mutationProb_; }
+  double mutationStep() const { return step_; }
+
+  // Everything evolve() carries from one generation to the next: members and
+  // scores, the random stream, the clone memo and the counters. load() expects
+  // a population of the same size.
+  void save(CheckpointWriter& out) const;
+  void load(CheckpointReader& in);
 
 private:
   size_t   populationSize_;
@@ -27,10 +85,65 @@ private:
   double   mutationProb_;
   size_t   tournamentSize_;
 
-  std::vector<Chromosome> chromosomes_;
-  std::vector<double>     fitnessValues_;
+  Rng rng_;
+
+  // Rows [0, N) hold the population, [N, 2N) the offspring of the current
+  // generation; scores_/scored_ run parallel to the rows. spare_ and its
+  // arrays receive the survivors.
+  GeneMatrix           members_;
+  std::vector<double>  scores_;
+  std::vector<uint8_t> scored_;
+  GeneMatrix           spare_;
+  std::vector<double>  spareScores_;
+  std::vector<uint8_t> spareScored_;
+  std::vector<size_t>  order_; // rows by fitness, for survivor selection and migration
+
+  // Adaptive variation: settings, and per offspring its first parent and the
+  // operators that changed it.
+  static constexpr double  TARGET_SUCCESS = 0.2;
+  static constexpr double  MIN_RATE = 0.05;
+  static constexpr double  MIN_STEP = 1e-3;
+  static constexpr double  MAX_STEP = 0.5;
+  static constexpr uint8_t CROSSED = 1;
+  static constexpr uint8_t MUTATED = 2;
+
+  AdaptiveVariation    adaptive_;
+  double               initialCrossoverProb_;
+  double               initialMutationProb_;
+  double               step_ = 0.0;
+  std::vector<size_t>  parent_;
+  std::vector<uint8_t> varied_;
+
+  // Recently scored gene vectors, so a clone of a chromosome that has since
+  // left the population is not scored again: an open-addressing table of
+  // hashes over a fixed matrix of genes, emptied when it cannot take another
+  // generation.
+  static constexpr size_t MEMO_MIN_ROWS = 4096;
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  GeneMatrix            memoGenes_;
+  std::vector<double>   memoFitness_; // per memo row
+  std::vector<size_t>   memoBatch_;   // per memo row: batch index while being scored, else NONE
+  std::vector<uint64_t> memoHash_;    // per slot
+  std::vector<size_t>   memoRow_;     // per slot: memo row, NONE if empty
+  size_t                memoUsed_ = 0;
+
+  // Scratch of evaluateFitness(), sized for 2N rows up front.
+  std::vector<const double*> batch_;
+  std::vector<size_t>        batchMemo_; // memo row of each batch entry
+  std::vector<size_t>        slot_;      // member row -> batch index, or NONE
+  std::vector<double>        results_;
+
+  EvaluationStats stats_;
+
+  // Scores every row in [0, rows) that does not carry a fitness yet.
+  void   evaluateFitness(size_t rows);
+  size_t tournamentSelect();
+  void   mutateOffspring(double* row, const GeneBounds* bounds);
+  void   adaptVariation();
 
-  void       evaluateFitness();
-  Chromosome tournamentSelect();
+  size_t findMemo(uint64_t hash, const double* genes) const;
+  size_t insertMemo(uint64_t hash, const double* genes);
+  void   clearMemo();
 };
 } // namespace ga
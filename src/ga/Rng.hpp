@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace ga {
+
+// xoshiro256** generator, usable with the <random> distributions.
+//
+// Each thread or island gets its own Rng, so nothing is shared or locked.
+// Streams are split off with fork(), which hands out the current state and
+// jumps this generator 2^128 steps ahead: streams forked from one seed never
+// overlap in practice and come out the same on every run, whatever the thread
+// timing.
+class Rng {
+public:
+  using result_type = uint64_t;
+
+  static constexpr uint64_t DEFAULT_SEED = 0x5eed;
+
+  explicit Rng(uint64_t seed = DEFAULT_SEED) {
+    // splitmix64 spreads any seed, 0 included, over the whole state.
+    for (uint64_t& word : s_) {
+      seed += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+  }
+
+  // Advances 2^128 steps.
+  void jump() {
+    static constexpr uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t                  s[4] = {0, 0, 0, 0};
+    for (uint64_t word : JUMP) {
+      for (int b = 0; b < 64; ++b) {
+        if (word & (uint64_t(1) << b)) {
+          for (int i = 0; i < 4; ++i)
+            s[i] ^= s_[i];
+        }
+        (*this)();
+      }
+    }
+    for (int i = 0; i < 4; ++i)
+      s_[i] = s[i];
+  }
+
+  // A generator for a new, independent stream.
+  Rng fork() {
+    Rng stream = *this;
+    jump();
+    return stream;
+  }
+
+  // Raw generator state, so a checkpoint can pick the stream up where it was.
+  using State = std::array<uint64_t, 4>;
+
+  State state() const { return {s_[0], s_[1], s_[2], s_[3]}; }
+  void  setState(const State& state) {
+    for (int i = 0; i < 4; ++i)
+      s_[i] = state[i];
+  }
+
+private:
+  uint64_t s_[4];
+
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+} // namespace ga
@@ -1,6 +1,7 @@
 #include "Selection.hpp"
 
 #include <algorithm>
+#include <random>
 #include <stdexcept>
 
 namespace ga {
@@ -10,12 +11,11 @@ Selection::Selection(size_t tournamentSize) : tournamentSize_(tournamentSize) {
     throw std::invalid_argument("Tournament size must be >= 2");
 }
 
-Chromosome Selection::tournamentSelect(const std::vector<Chromosome>& population,
-                                       const std::vector<double>& fitnesses, std::mt19937& rng) {
-  if (population.empty() || population.size() != fitnesses.size())
-    throw std::runtime_error("Population and fitnesses must be same non-zero size");
+size_t Selection::tournamentSelect(const std::vector<double>& fitnesses, Rng& rng) {
+  if (fitnesses.empty())
+    throw std::runtime_error("Population must be non-empty");
 
-  std::uniform_int_distribution<size_t> dist(0, population.size() - 1);
+  std::uniform_int_distribution<size_t> dist(0, fitnesses.size() - 1);
   size_t                                bestIdx = dist(rng);
   double                                bestFitness = fitnesses[bestIdx];
 
@@ -26,18 +26,14 @@ Chromosome Selection::tournamentSelect(const std::vector<Chromosome>& population
       bestIdx = idx;
     }
   }
-  return population[bestIdx];
+  return bestIdx;
 }
 
-std::vector<Chromosome> Selection::selectPopulation(const std::vector<Chromosome>& population,
-                                                    const std::vector<double>&     fitnesses,
-                                                    size_t numSelected, std::mt19937& rng) {
-  std::vector<Chromosome> selected;
-  selected.reserve(numSelected);
-
+void Selection::selectPopulation(const std::vector<double>& fitnesses, size_t numSelected,
+                                 Rng& rng, std::vector<size_t>& selected) {
+  selected.clear();
   for (size_t i = 0; i < numSelected; ++i) {
-    selected.push_back(tournamentSelect(population, fitnesses, rng));
+    selected.push_back(tournamentSelect(fitnesses, rng));
   }
-  return selected;
 }
 } // namespace ga
@@ -1,22 +1,23 @@
 #pragma once
 #include "Chromosome.hpp"
+#include "Rng.hpp"
 #include "ga_config.hpp"
 
-#include <random>
 #include <vector>
 
 namespace ga {
 
+// Tournament selection over a population's fitness values; picks are returned
+// as member indices so callers can copy genes straight between matrix rows.
 class Selection {
 public:
   Selection(size_t tournamentSize = 3);
 
-  Chromosome tournamentSelect(const std::vector<Chromosome>& population,
-                              const std::vector<double>& fitnesses, std::mt19937& rng);
+  size_t tournamentSelect(const std::vector<double>& fitnesses, Rng& rng);
 
-  std::vector<Chromosome> selectPopulation(const std::vector<Chromosome>& population,
-                                           const std::vector<double>& fitnesses, size_t numSelected,
-                                           std::mt19937& rng);
+  // Fills `selected` with numSelected picks; reuses its capacity.
+  void selectPopulation(const std::vector<double>& fitnesses, size_t numSelected, Rng& rng,
+                        std::vector<size_t>& selected);
 
 private:
   size_t tournamentSize_;
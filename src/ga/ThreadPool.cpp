@@ -0,0 +1,118 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace ga {
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (size_t w = 0; w < threads; ++w)
+    queues_.push_back(std::make_unique<Queue>());
+  for (size_t w = 1; w < threads; ++w)
+    threads_.emplace_back([this, w] { workerLoop(w); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : threads_)
+    t.join();
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t, size_t)>& fn) {
+  if (n == 0)
+    return;
+
+  if (threads_.empty()) {
+    for (size_t i = 0; i < n; ++i)
+      fn(i, 0);
+    return;
+  }
+
+  const size_t workers = queues_.size();
+  for (size_t w = 0; w < workers; ++w) {
+    std::lock_guard<std::mutex> lock(queues_[w]->mutex);
+    for (size_t i = n * w / workers; i < n * (w + 1) / workers; ++i)
+      queues_[w]->items.push_back(i);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fn;
+    error_ = nullptr;
+    busy_ = threads_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  drain(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [&] { return busy_ == 0; });
+  job_ = nullptr;
+  if (error_)
+    std::rethrow_exception(error_);
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+  size_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_)
+        return;
+      seen = generation_;
+    }
+
+    drain(worker);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_ == 0)
+      idle_.notify_one();
+  }
+}
+
+void ThreadPool::drain(size_t worker) {
+  size_t item;
+  while (take(worker, item)) {
+    try {
+      (*job_)(item, worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+    }
+  }
+}
+
+bool ThreadPool::take(size_t worker, size_t& item) {
+  {
+    Queue&                      own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.items.empty()) {
+      item = own.items.front();
+      own.items.pop_front();
+      return true;
+    }
+  }
+
+  // Items are only added before a job starts, so once every queue has been
+  // seen empty there is nothing left to take.
+  for (size_t k = 1; k < queues_.size(); ++k) {
+    Queue&                      victim = *queues_[(worker + k) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.items.empty()) {
+      item = victim.items.back();
+      victim.items.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace ga
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ga {
+
+// Fixed set of threads running index loops with work stealing.
+//
+// parallelFor() deals the indices out in contiguous shares, one queue per
+// worker. A worker takes from the front of its own queue and, once that is
+// empty, steals from the back of the others', so a share holding the expensive
+// items is finished by whoever is idle rather than by its owner alone. The
+// calling thread works as worker 0; a pool of size 1 runs everything inline.
+class ThreadPool {
+public:
+  // `threads` workers in total, the caller included; 0 means one per core.
+  explicit ThreadPool(size_t threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t size() const { return queues_.size(); }
+
+  // Calls fn(i, worker) for every i in [0, n) and returns once all calls are
+  // done. `worker` (< size()) identifies the executing thread, so callers can
+  // keep per-worker scratch state. Which worker runs which index is not fixed.
+  // The first exception thrown by fn is rethrown here after the loop drains.
+  void parallelFor(size_t n, const std::function<void(size_t, size_t)>& fn);
+
+private:
+  struct alignas(64) Queue {
+    std::mutex         mutex;
+    std::deque<size_t> items;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread>            threads_;
+
+  std::mutex                                mutex_; // guards everything below
+  std::condition_variable                   wake_;  // a job was posted, or stop
+  std::condition_variable                   idle_;  // a worker finished the job
+  const std::function<void(size_t, size_t)>* job_ = nullptr;
+  size_t                                    generation_ = 0;
+  size_t                                    busy_ = 0; // helper threads inside the job
+  bool                                      stop_ = false;
+  std::exception_ptr                        error_;
+
+  void workerLoop(size_t worker);
+
+  // Runs items until every queue is empty.
+  void drain(size_t worker);
+
+  bool take(size_t worker, size_t& item);
+};
+} // namespace ga
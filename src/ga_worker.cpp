@@ -0,0 +1,45 @@
+#include "ga/Distributed.hpp"
+
+#include <iostream>
+#include <string>
+
+void printUsage(const char* progName) {
+  std::cout << "Usage: " << progName << " <coordinator_address> [options]\n\n";
+  std::cout << "Scores fitness batches for an optimizer started with --listen.\n";
+  std::cout << "The address is host:port or unix:/path.\n\n";
+  std::cout << "Options:\n";
+  std::cout << "  --threads N          Scoring threads, 0 = one per core (default: 0)\n";
+  std::cout << "  --data FILE          Local copy of the coordinator's training cache file\n";
+  std::cout << "  --connect-timeout S  Seconds to keep retrying the connection (default: 30)\n";
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  std::string address = argv[1];
+  size_t      threads = 0;
+  std::string dataPath;
+  double      connectTimeout = 30.0;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool        hasValue = i + 1 < argc;
+    if (arg == "--threads" && hasValue)
+      threads = std::stoul(argv[++i]);
+    else if (arg == "--data" && hasValue)
+      dataPath = argv[++i];
+    else if (arg == "--connect-timeout" && hasValue)
+      connectTimeout = std::stod(argv[++i]);
+  }
+
+  try {
+    ga::runWorker(address, threads, dataPath, connectTimeout);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
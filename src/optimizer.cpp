@@ -1,12 +1,23 @@
 #include "analysis/Analysis.hpp"
+#include "ga/Distributed.hpp"
 #include "ga/Fitness.hpp"
 #include "ga/GAEngine.hpp"
 #include "preprocessing/AdsbDataPreprocessor.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const char* const DEFAULT_CHECKPOINT = "results/ga_checkpoint.bin";
 
 void printUsage(const char* progName) {
   std::cout << "Usage: " << progName << " <adsb_csv_file> [options]\n\n";
@@ -16,6 +27,40 @@ void printUsage(const char* progName) {
   std::cout << "  --train-split R    Training split ratio 0.0-1.0 (default: 0.8)\n";
   std::cout
       << "  --output FILE      Output file for results (default: results/optimized_params.txt)\n";
+  std::cout << "  --cache-dir DIR    Preprocessing cache directory (default: results/cache)\n";
+  std::cout << "  --no-cache         Always re-run preprocessing, bypassing the cache\n";
+  std::cout << "  --out-of-core      Stream training samples from the cache file during the GA\n";
+  std::cout << "  --block-rows N     Rows per streamed block in out-of-core mode (default: 65536)\n";
+  std::cout << "  --sugeno           Zero-order Sugeno inference instead of Mamdani centroid\n";
+  std::cout << "  --threads N        Fitness evaluation threads, 0 = one per core (default: 0)\n";
+  std::cout << "  --islands K        Split the population into K islands, one thread each\n";
+  std::cout << "  --migration-interval G\n";
+  std::cout << "                     Generations between island migrations (default: 10)\n";
+  std::cout << "  --migrants M       Members each island sends per migration (default: 2)\n";
+  std::cout << "  --topology T       Island migration topology, ring or random (default: ring)\n";
+  std::cout << "  --listen ADDR      Score fitness on ga_worker processes connecting to ADDR\n";
+  std::cout << "                     (host:port or unix:/path)\n";
+  std::cout << "  --local-workers N  Fork N single-threaded workers on this machine\n";
+  std::cout << "  --seed N           Random seed; the same seed repeats a run (default: random)\n";
+  std::cout << "  --checkpoint FILE  Save GA state to FILE periodically\n";
+  std::cout << "                     (default with the options below: results/ga_checkpoint.bin)\n";
+  std::cout << "  --checkpoint-every G\n";
+  std::cout << "                     Generations between checkpoints (default: 10)\n";
+  std::cout << "  --checkpoint-seconds S\n";
+  std::cout << "                     Also checkpoint after S seconds of wall time\n";
+  std::cout << "  --resume           Continue bit-exactly from the checkpoint; other options\n";
+  std::cout << "                     must match the interrupted run\n";
+  std::cout << "  --adaptive         Adapt crossover/mutation rates and a Gaussian mutation step\n";
+  std::cout << "                     by the 1/5 success rule instead of fixed uniform mutation\n";
+  std::cout << "  --mutation-step S  Initial adaptive step, share of gene range (default: 0.3)\n";
+  std::cout << "  --stagnation G     Stop once best fitness has risen by no more than\n";
+  std::cout << "                     --min-improvement D (default: 0) in G generations\n";
+  std::cout << "  --target-fitness F Stop once best fitness reaches F\n";
+  std::cout << "  --time-limit S     Stop the GA after S seconds of wall time\n";
+  std::cout << "  --validation-every K\n";
+  std::cout << "                     Score the best chromosome on the validation split every K\n";
+  std::cout << "                     generations; stop after --validation-patience P checks\n";
+  std::cout << "                     (default: 3) without improvement\n";
   std::cout << "\nExample:\n";
   std::cout << "  " << progName << " data/flight_data.csv --generations 100 --population 200\n";
 }
@@ -55,6 +100,45 @@ void saveOptimizedParameters(const std::string& filename, const ga::Chromosome&
   std::cout << "\nOptimized parameters saved to: " << filename << "\n";
 }
 
+// Worker processes forked by --local-workers; stopped and reaped on scope exit.
+class LocalWorkers {
+public:
+  LocalWorkers() = default;
+  LocalWorkers(const LocalWorkers&) = delete;
+  LocalWorkers& operator=(const LocalWorkers&) = delete;
+
+  ~LocalWorkers() {
+    for (pid_t pid : pids_) {
+      ::kill(pid, SIGTERM);
+      ::waitpid(pid, nullptr, 0);
+    }
+  }
+
+  // Must run before this process starts any threads.
+  void spawn(const std::string& address, size_t count) {
+    std::cout.flush();
+    for (size_t k = 0; k < count; ++k) {
+      pid_t pid = ::fork();
+      if (pid < 0)
+        throw std::runtime_error("Failed to fork a local worker");
+      if (pid == 0) {
+        int status = 0;
+        try {
+          ga::runWorker(address, 1);
+        } catch (const std::exception& e) {
+          std::cerr << "Local worker: " << e.what() << "\n";
+          status = 1;
+        }
+        std::_Exit(status);
+      }
+      pids_.push_back(pid);
+    }
+  }
+
+private:
+  std::vector<pid_t> pids_;
+};
+
 int main(int argc, char* argv[]) {
   std::cout << "========================================\n";
   std::cout << "ADS-B FUZZY SYSTEM GA OPTIMIZER\n";
@@ -71,35 +155,143 @@ int main(int argc, char* argv[]) {
   int         populationSize = 100;
   double      trainSplit = 0.8;
   std::string outputFile = "results/optimized_params.txt";
-
-  for (int i = 2; i < argc - 1; i += 2) {
+  std::string cacheDir = "results/cache";
+  bool        outOfCore = false;
+  size_t      blockRows = 65536;
+  auto        inference = fuzzy::InferenceMode::MAMDANI;
+  size_t      threads = 0;
+  size_t      islands = 1;
+  std::string listen;
+  size_t      localWorkers = 0;
+  bool        hasSeed = false;
+  uint64_t    seed = 0;
+  bool        resume = false;
+
+  ga::CheckpointPolicy  checkpoint;
+  ga::StoppingCriteria  stopping;
+  ga::AdaptiveVariation adaptive;
+  size_t                validationEvery = 0;
+
+  ga::MigrationPolicy migration;
+
+  for (int i = 2; i < argc; ++i) {
     std::string arg = argv[i];
-    if (arg == "--generations")
-      generations = std::stoi(argv[i + 1]);
-    else if (arg == "--population")
-      populationSize = std::stoi(argv[i + 1]);
-    else if (arg == "--train-split")
-      trainSplit = std::stod(argv[i + 1]);
-    else if (arg == "--output")
-      outputFile = argv[i + 1];
+    bool        hasValue = i + 1 < argc;
+    if (arg == "--no-cache")
+      cacheDir.clear();
+    else if (arg == "--out-of-core")
+      outOfCore = true;
+    else if (arg == "--sugeno")
+      inference = fuzzy::InferenceMode::SUGENO;
+    else if (arg == "--threads" && hasValue)
+      threads = std::stoul(argv[++i]);
+    else if (arg == "--listen" && hasValue)
+      listen = argv[++i];
+    else if (arg == "--local-workers" && hasValue)
+      localWorkers = std::stoul(argv[++i]);
+    else if (arg == "--adaptive")
+      adaptive.enabled = true;
+    else if (arg == "--mutation-step" && hasValue)
+      adaptive.step = std::stod(argv[++i]);
+    else if (arg == "--stagnation" && hasValue)
+      stopping.stagnationGenerations = std::stoul(argv[++i]);
+    else if (arg == "--min-improvement" && hasValue)
+      stopping.minImprovement = std::stod(argv[++i]);
+    else if (arg == "--target-fitness" && hasValue)
+      stopping.targetFitness = std::stod(argv[++i]);
+    else if (arg == "--time-limit" && hasValue)
+      stopping.maxSeconds = std::stod(argv[++i]);
+    else if (arg == "--validation-every" && hasValue)
+      validationEvery = std::stoul(argv[++i]);
+    else if (arg == "--validation-patience" && hasValue)
+      stopping.validationPatience = std::stoul(argv[++i]);
+    else if (arg == "--resume")
+      resume = true;
+    else if (arg == "--checkpoint" && hasValue)
+      checkpoint.path = argv[++i];
+    else if (arg == "--checkpoint-every" && hasValue) {
+      checkpoint.generations = std::stoul(argv[++i]);
+      checkpoint.path = checkpoint.path.empty() ? DEFAULT_CHECKPOINT : checkpoint.path;
+    } else if (arg == "--checkpoint-seconds" && hasValue) {
+      checkpoint.seconds = std::stod(argv[++i]);
+      checkpoint.path = checkpoint.path.empty() ? DEFAULT_CHECKPOINT : checkpoint.path;
+    } else if (arg == "--seed" && hasValue) {
+      seed = std::stoull(argv[++i]);
+      hasSeed = true;
+    } else if (arg == "--islands" && hasValue)
+      islands = std::stoul(argv[++i]);
+    else if (arg == "--migration-interval" && hasValue)
+      migration.interval = std::stoul(argv[++i]);
+    else if (arg == "--migrants" && hasValue)
+      migration.migrants = std::stoul(argv[++i]);
+    else if (arg == "--topology" && hasValue) {
+      std::string topology = argv[++i];
+      if (topology != "ring" && topology != "random") {
+        std::cerr << "Error: --topology must be ring or random\n";
+        return 1;
+      }
+      migration.topology =
+          topology == "ring" ? ga::MigrationTopology::RING : ga::MigrationTopology::RANDOM;
+    } else if (arg == "--block-rows" && hasValue)
+      blockRows = std::stoul(argv[++i]);
+    else if (arg == "--generations" && hasValue)
+      generations = std::stoi(argv[++i]);
+    else if (arg == "--population" && hasValue)
+      populationSize = std::stoi(argv[++i]);
+    else if (arg == "--train-split" && hasValue)
+      trainSplit = std::stod(argv[++i]);
+    else if (arg == "--output" && hasValue)
+      outputFile = argv[++i];
+    else if (arg == "--cache-dir" && hasValue)
+      cacheDir = argv[++i];
   }
 
+  if (resume && checkpoint.path.empty())
+    checkpoint.path = DEFAULT_CHECKPOINT;
+
   std::cout << "Configuration:\n";
   std::cout << "  Input CSV:      " << csvPath << "\n";
   std::cout << "  Generations:    " << generations << "\n";
   std::cout << "  Population:     " << populationSize << "\n";
+  if (islands > 1)
+    std::cout << "  Islands:        " << islands << "\n";
   std::cout << "  Train/Val:      " << (trainSplit * 100) << "% / " << ((1.0 - trainSplit) * 100)
             << "%\n";
-  std::cout << "  Output file:    " << outputFile << "\n\n";
+  std::cout << "  Output file:    " << outputFile << "\n";
+  std::cout << "  Cache dir:      " << (cacheDir.empty() ? "(disabled)" : cacheDir) << "\n";
+  std::cout << "  Out-of-core:    " << (outOfCore ? "yes" : "no") << "\n";
+  if (adaptive.enabled)
+    std::cout << "  Variation:      adaptive (initial step " << adaptive.step << ")\n";
+  if (!checkpoint.path.empty())
+    std::cout << "  Checkpoint:     " << checkpoint.path << (resume ? " (resuming)" : "") << "\n";
+  std::cout << "  Inference:      "
+            << (inference == fuzzy::InferenceMode::SUGENO ? "Sugeno" : "Mamdani") << "\n\n";
+
+  if (outOfCore && cacheDir.empty()) {
+    std::cerr << "Error: --out-of-core streams from the preprocessing cache; drop --no-cache\n";
+    return 1;
+  }
 
+  if (localWorkers > 0 && listen.empty())
+    listen = "unix:/tmp/adsb_ga_" + std::to_string(::getpid()) + ".sock";
+
+  LocalWorkers workerProcesses;
   try {
+    // Listen before forking so local workers connect straight away; both
+    // happen before any thread exists.
+    std::unique_ptr<ga::Coordinator> coordinator;
+    if (!listen.empty()) {
+      coordinator = std::make_unique<ga::Coordinator>(listen);
+      workerProcesses.spawn(listen, localWorkers);
+    }
+
     std::cout << "Step 1: Data Preprocessing\n";
     std::cout << std::string(50, '-') << "\n";
 
     adsb::AdsbDataPreprocessor preprocessor;
-    auto [inputs, outputs] = preprocessor.process(csvPath);
+    auto                       data = preprocessor.loadDataset(csvPath, cacheDir);
 
-    if (inputs.empty()) {
+    if (data->size() == 0) {
       std::cerr << "Error: No valid samples after preprocessing\n";
       return 1;
     }
@@ -107,17 +299,10 @@ int main(int argc, char* argv[]) {
     std::cout << "\nStep 2: Train/Validation Split\n";
     std::cout << std::string(50, '-') << "\n";
 
-    size_t trainSize = static_cast<size_t>(inputs.size() * trainSplit);
+    auto [trainSet, valSet] = dataset::DatasetView(data).split(trainSplit);
 
-    std::vector<std::map<std::string, double>> trainInputs(inputs.begin(),
-                                                           inputs.begin() + trainSize);
-    std::vector<double> trainOutputs(outputs.begin(), outputs.begin() + trainSize);
-
-    std::vector<std::map<std::string, double>> valInputs(inputs.begin() + trainSize, inputs.end());
-    std::vector<double> valOutputs(outputs.begin() + trainSize, outputs.end());
-
-    std::cout << "Training samples:   " << trainInputs.size() << "\n";
-    std::cout << "Validation samples: " << valInputs.size() << "\n";
+    std::cout << "Training samples:   " << trainSet.size() << "\n";
+    std::cout << "Validation samples: " << valSet.size() << "\n";
 
     std::cout << "\nStep 3: Baseline Evaluation\n";
     std::cout << std::string(50, '-') << "\n";
@@ -125,9 +310,9 @@ int main(int argc, char* argv[]) {
     ga::Chromosome defaultChromosome;
 
     auto baselineTrainMetrics =
-        analysis::Validator::evaluate(trainInputs, trainOutputs, defaultChromosome);
+        analysis::Validator::evaluate(trainSet, defaultChromosome, 0.5, inference);
     auto baselineValMetrics =
-        analysis::Validator::evaluate(valInputs, valOutputs, defaultChromosome);
+        analysis::Validator::evaluate(valSet, defaultChromosome, 0.5, inference);
 
     analysis::Validator::printMetrics("Baseline Training", baselineTrainMetrics);
     analysis::Validator::printMetrics("Baseline Validation", baselineValMetrics);
@@ -135,20 +320,94 @@ int main(int argc, char* argv[]) {
     std::cout << "\nStep 4: GA Optimization\n";
     std::cout << std::string(50, '-') << "\n";
 
-    ga::Fitness  fitness(trainInputs, trainOutputs);
+    // One evaluator per island, each over the same samples; in-memory ones
+    // share the dataset through views, so only their caches are per island.
+    ga::StreamingSource source;
+    if (outOfCore) {
+      if (data->sourceFile().empty())
+        throw std::runtime_error("Out-of-core mode requires a writable cache directory");
+
+      source.path = data->sourceFile();
+      source.beginRow = trainSet.rowIndex(0);
+      source.endRow = source.beginRow + trainSet.size();
+      source.blockRows = blockRows;
+      std::cout << "Streaming training samples from " << source.path << " in blocks of "
+                << blockRows << " rows\n";
+    }
+
+    islands = std::max<size_t>(islands, 1);
+    const size_t totalThreads =
+        threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::unique_ptr<ga::Fitness>> evaluators;
+    std::vector<ga::Fitness*>                 islandFitness;
+    for (size_t k = 0; k < islands; ++k) {
+      if (outOfCore)
+        evaluators.push_back(std::make_unique<ga::Fitness>(source));
+      else
+        evaluators.push_back(std::make_unique<ga::Fitness>(trainSet));
+      ga::Fitness& fitness = *evaluators.back();
+      fitness.setInferenceMode(inference);
+      fitness.setThreads(islands > 1 ? std::max<size_t>(1, totalThreads / islands) : threads);
+      fitness.setMembershipCacheBytes(ga::Fitness::DEFAULT_MEMBERSHIP_CACHE_BYTES / islands);
+      fitness.setCoordinator(coordinator.get());
+      islandFitness.push_back(&fitness);
+    }
+    if (coordinator)
+      std::cout << "Scoring fitness on workers at " << listen << " (" << localWorkers
+                << " local)\n";
+    else if (islands > 1)
+      std::cout << "Evaluating fitness on " << islands << " islands x "
+                << evaluators[0]->threads() << " thread(s)\n";
+    else
+      std::cout << "Evaluating fitness on " << evaluators[0]->threads() << " thread(s)\n";
+
     ga::GAEngine ga(populationSize, generations, 0.8, 0.2, 3);
-    ga.setFitnessEvaluator(&fitness);
+    ga.setIslands(islandFitness, migration);
+    if (hasSeed)
+      ga.setSeed(seed);
+    ga.setCheckpoints(checkpoint);
+    if (resume)
+      ga.resumeFrom(checkpoint.path);
+
+    // Scored locally: workers only hold the training rows.
+    std::unique_ptr<ga::Fitness> validation;
+    if (validationEvery > 0) {
+      validation = std::make_unique<ga::Fitness>(valSet);
+      validation->setInferenceMode(inference);
+      validation->setThreads(threads);
+      stopping.validation = validation.get();
+      stopping.validationInterval = validationEvery;
+    }
+    ga.setStoppingCriteria(stopping);
+    ga.setAdaptiveVariation(adaptive);
 
     std::cout << "Starting optimization...\n\n";
     ga.run();
 
+    if (coordinator) {
+      ga::DistributedStats remote = coordinator->stats();
+      std::cout << "Workers: " << remote.workersJoined << " joined, " << remote.workersLost
+                << " lost; " << remote.tasks << " tasks (" << remote.reassigned
+                << " reassigned)\n";
+    } else if (!outOfCore) {
+      ga::MembershipCacheStats cache;
+      for (const auto& fitness : evaluators) {
+        cache.hits += fitness->membershipCacheStats().hits;
+        cache.misses += fitness->membershipCacheStats().misses;
+      }
+      std::cout << "Membership columns reused: " << cache.hits << " of "
+                << cache.hits + cache.misses << " input fuzzifications\n";
+    }
+
     std::cout << "\nStep 5: Optimized System Evaluation\n";
     std::cout << std::string(50, '-') << "\n";
 
     const auto& bestChromosome = ga.bestChromosome();
 
-    auto optTrainMetrics = analysis::Validator::evaluate(trainInputs, trainOutputs, bestChromosome);
-    auto optValMetrics = analysis::Validator::evaluate(valInputs, valOutputs, bestChromosome);
+    auto optTrainMetrics =
+        analysis::Validator::evaluate(trainSet, bestChromosome, 0.5, inference);
+    auto optValMetrics =
+        analysis::Validator::evaluate(valSet, bestChromosome, 0.5, inference);
 
     analysis::Validator::printMetrics("Optimized Training", optTrainMetrics);
     analysis::Validator::printMetrics("Optimized Validation", optValMetrics);
@@ -193,9 +452,9 @@ int main(int argc, char* argv[]) {
     saveOptimizedParameters(outputFile, bestChromosome, optTrainMetrics, optValMetrics);
 
     std::cout << "\nGenerating analysis files...\n";
-    analysis::Validator::saveDetailedResults(trainInputs, trainOutputs, valInputs, valOutputs,
-                                             baselineTrainMetrics, baselineValMetrics,
-                                             optTrainMetrics, optValMetrics, bestChromosome);
+    analysis::Validator::saveDetailedResults(valSet, baselineTrainMetrics, baselineValMetrics,
+                                             optTrainMetrics, optValMetrics, bestChromosome,
+                                             inference);
 
     std::cout << "\n" << std::string(50, '=') << "\n";
     std::cout << "OPTIMIZATION COMPLETE\n";
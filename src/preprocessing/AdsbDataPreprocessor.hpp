@@ -2,18 +2,33 @@
 
 #include "../adsb/AdsbCsvParser.hpp"
 #include "../adsb/AdsbState.hpp"
+#include "../dataset/ColumnarFile.hpp"
+#include "../dataset/Dataset.hpp"
+#include "../dataset/Fingerprint.hpp"
 #include "../feature/FeatureExtractor.hpp"
 #include "../feature/FeatureVector.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace adsb {
 
+// Column order of the cached feature matrix; matches the fuzzy input order.
+const std::vector<std::string> FEATURE_NAMES = {"SpeedChange", "HeadingChange",
+                                                "VerticalRateChange", "AltitudeChange", "TimeGap"};
+
+// Bump whenever the preprocessing pipeline changes in a way that alters its output,
+// so stale cache entries are not reused.
+constexpr uint64_t PREPROCESSING_VERSION = 1;
+
 struct TrainingSample {
   std::map<std::string, double> inputs;
   double                        expectedOutput;
@@ -48,7 +63,96 @@ public:
 
   std::pair<std::vector<std::map<std::string, double>>, std::vector<double>>
   process(const std::string& csvPath) {
+    auto labeled = processSamples(csvPath);
+
+    std::vector<std::map<std::string, double>> inputs;
+    std::vector<double>                        outputs;
+    inputs.reserve(labeled.size());
+    outputs.reserve(labeled.size());
+
+    for (const auto& sample : labeled) {
+      inputs.push_back(sample.inputs);
+      outputs.push_back(sample.expectedOutput);
+    }
+
+    printStatistics(*dataset::Dataset::fromSamples(FEATURE_NAMES, inputs, outputs));
+
+    return {inputs, outputs};
+  }
+
+  // Runs the pipeline into a shared, immutable Dataset with FEATURE_NAMES columns.
+  // With a non-empty `cacheDir` the result is stored there under a key derived from
+  // the CSV contents and every Config field, and returned as a memory mapping of
+  // that file; repeated runs on unchanged input skip preprocessing entirely.
+  std::shared_ptr<const dataset::Dataset> loadDataset(const std::string& csvPath,
+                                                      const std::string& cacheDir = "") {
+    if (cacheDir.empty())
+      return buildDataset(csvPath);
+
+    uint64_t    key = cacheKey(csvPath);
+    std::string path = cachePath(key, cacheDir);
+
+    if (std::filesystem::exists(path)) {
+      try {
+        auto data = mapCached(path, key);
+        std::cout << "Loaded " << data->size() << " preprocessed samples from cache: " << path
+                  << "\n";
+        printStatistics(*data);
+        return data;
+      } catch (const std::exception& e) {
+        std::cerr << "Warning: Ignoring unreadable cache entry (" << e.what() << ")\n";
+      }
+    }
+
+    auto data = buildDataset(csvPath);
+    try {
+      std::filesystem::create_directories(cacheDir);
+      std::vector<const double*> columns;
+      for (size_t f = 0; f < data->features(); ++f)
+        columns.push_back(data->column(f));
+      dataset::ColumnarFile::write(path, FEATURE_NAMES, columns, data->labels(), data->size(),
+                                   key);
+      std::cout << "Cached preprocessed samples to: " << path << "\n";
+      return mapCached(path, key);
+    } catch (const std::exception& e) {
+      std::cerr << "Warning: Could not write preprocessing cache (" << e.what() << ")\n";
+    }
+    return data;
+  }
+
+  static std::string cachePath(uint64_t key, const std::string& cacheDir) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.adsbcol", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(cacheDir) / name).string();
+  }
+
+  // Key over the CSV contents, the pipeline version and every Config field.
+  uint64_t cacheKey(const std::string& csvPath) const {
+    static_assert(sizeof(Config) == 10 * sizeof(double),
+                  "Config changed: update cacheKey() to hash every field");
+
+    dataset::Fingerprint fp;
+    fp.update(PREPROCESSING_VERSION);
+    fp.update(dataset::Fingerprint::ofFile(csvPath));
+    fp.update(config_.maxTimeGap);
+    fp.update(config_.maxSpeedChange);
+    fp.update(config_.maxHeadingChange);
+    fp.update(config_.maxVertRateChange);
+    fp.update(config_.maxAltitudeChange);
+    fp.update(config_.speedChangeRange);
+    fp.update(config_.headingChangeRange);
+    fp.update(config_.vertRateChangeRange);
+    fp.update(config_.altitudeChangeRange);
+    fp.update(config_.timeGapMax);
+    for (const auto& name : FEATURE_NAMES)
+      fp.update(name);
+    return fp.value();
+  }
 
+private:
+  Config config_;
+
+  std::vector<TrainingSample> processSamples(const std::string& csvPath) {
     std::cout << "Loading ADS-B data from: " << csvPath << "\n";
     auto states = AdsbCsvParser::load(csvPath);
     std::cout << "Loaded " << states.size() << " ADS-B states\n";
@@ -66,25 +170,38 @@ public:
     std::cout << "Retained " << filtered.size() << " samples after filtering\n";
 
     std::cout << "Generating labels using expert rules...\n";
-    auto labeled = applyExpertRules(filtered);
+    return applyExpertRules(filtered);
+  }
+
+  std::shared_ptr<const dataset::Dataset> buildDataset(const std::string& csvPath) {
+    auto labeled = processSamples(csvPath);
 
     std::vector<std::map<std::string, double>> inputs;
     std::vector<double>                        outputs;
     inputs.reserve(labeled.size());
     outputs.reserve(labeled.size());
 
-    for (const auto& sample : labeled) {
-      inputs.push_back(sample.inputs);
+    for (auto& sample : labeled) {
+      inputs.push_back(std::move(sample.inputs));
       outputs.push_back(sample.expectedOutput);
     }
 
-    printStatistics(inputs, outputs);
-
-    return {inputs, outputs};
+    auto data = dataset::Dataset::fromSamples(FEATURE_NAMES, inputs, outputs);
+    printStatistics(*data);
+    return data;
   }
 
-private:
-  Config config_;
+  static std::shared_ptr<const dataset::Dataset> mapCached(const std::string& path,
+                                                           uint64_t           key) {
+    auto file = std::make_shared<const dataset::MappedColumnarFile>(path);
+    if (file->key() != key || file->features() != FEATURE_NAMES.size())
+      throw std::runtime_error("Stale cache entry: " + path);
+    for (size_t f = 0; f < FEATURE_NAMES.size(); ++f) {
+      if (file->name(f) != FEATURE_NAMES[f])
+        throw std::runtime_error("Unexpected column layout in cache entry: " + path);
+    }
+    return dataset::Dataset::fromMapped(file);
+  }
 
   std::vector<TrainingSample> convertToSamples(const std::vector<FeatureVector>& features) {
     std::vector<TrainingSample> samples;
@@ -220,43 +337,43 @@ private:
 
   double normalizeTimeGap(double raw) { return std::clamp(raw, 0.0, config_.timeGapMax); }
 
-  void printStatistics(const std::vector<std::map<std::string, double>>& inputs,
-                       const std::vector<double>&                        outputs) {
+  void printStatistics(const dataset::Dataset& data) {
     std::cout << "\n=== Dataset Statistics ===\n";
-    std::cout << "Total samples: " << inputs.size() << "\n\n";
+    std::cout << "Total samples: " << data.size() << "\n\n";
 
-    int low = 0, medium = 0, high = 0;
-    for (double out : outputs) {
-      if (out < 0.4)
+    const double* outputs = data.labels();
+    int           low = 0, medium = 0, high = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+      if (outputs[i] < 0.4)
         low++;
-      else if (out < 0.7)
+      else if (outputs[i] < 0.7)
         medium++;
       else
         high++;
     }
 
     std::cout << "Anomaly distribution:\n";
-    std::cout << "  Low (< 0.4):      " << low << " (" << (100.0 * low / outputs.size()) << "%)\n";
-    std::cout << "  Medium (0.4-0.7): " << medium << " (" << (100.0 * medium / outputs.size())
-              << "%)\n";
-    std::cout << "  High (> 0.7):     " << high << " (" << (100.0 * high / outputs.size())
+    std::cout << "  Low (< 0.4):      " << low << " (" << (100.0 * low / data.size()) << "%)\n";
+    std::cout << "  Medium (0.4-0.7): " << medium << " (" << (100.0 * medium / data.size())
               << "%)\n";
+    std::cout << "  High (> 0.7):     " << high << " (" << (100.0 * high / data.size()) << "%)\n";
 
     std::cout << "\nFeature ranges:\n";
-    for (const auto& [key, _] : inputs[0]) {
-      double minVal = std::numeric_limits<double>::max();
-      double maxVal = std::numeric_limits<double>::lowest();
-      double sum = 0.0;
-
-      for (const auto& input : inputs) {
-        double val = input.at(key);
-        minVal = std::min(minVal, val);
-        maxVal = std::max(maxVal, val);
-        sum += val;
+    for (size_t f = 0; f < data.features(); ++f) {
+      const double* column = data.column(f);
+      double        minVal = std::numeric_limits<double>::max();
+      double        maxVal = std::numeric_limits<double>::lowest();
+      double        sum = 0.0;
+
+      for (size_t i = 0; i < data.size(); ++i) {
+        minVal = std::min(minVal, column[i]);
+        maxVal = std::max(maxVal, column[i]);
+        sum += column[i];
       }
 
-      double mean = sum / inputs.size();
-      std::cout << "  " << key << ": [" << minVal << ", " << maxVal << "] mean=" << mean << "\n";
+      double mean = sum / data.size();
+      std::cout << "  " << data.featureNames()[f] << ": [" << minVal << ", " << maxVal
+                << "] mean=" << mean << "\n";
     }
     std::cout << "\n";
   }
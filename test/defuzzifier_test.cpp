@@ -0,0 +1,48 @@
+#include "../src/fuzzy/AdsbFuzzyVariable.hpp"
+#include "../src/fuzzy/Defuzzifier.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace fuzzy;
+
+// Checks the closed-form centroid against a dense sampled one, and a
+// coarse 101-point grid against the exact value, for a sweep of firing strengths.
+int main() {
+  const std::vector<std::vector<double>> outputs = {
+      {0.2, 0.4, 0.2, 0.5, 0.8, 0.6, 0.8},   // default AnomalyLevel
+      {0.05, 0.3, 0.1, 0.45, 0.9, 0.4, 0.95}, // wide, overlapping terms
+      {0.0, 1.0, 0.0, 0.5, 1.0, 0.0, 1.0},   // terms spanning the whole universe
+  };
+  const std::vector<double> levels = {0.0, 1e-12, 0.1, 0.35, 0.5, 0.9, 1.0};
+
+  Defuzzifier exact = Defuzzifier::exact();
+  Defuzzifier dense = Defuzzifier::sampled(200001);
+  Defuzzifier coarse = Defuzzifier::sampled(101);
+
+  double maxDense = 0.0, maxCoarse = 0.0;
+  int    cases = 0;
+  for (const auto& params : outputs) {
+    FuzzyVariable out = createAnomalyLevelVariable(params);
+    for (double low : levels) {
+      for (double medium : levels) {
+        for (double high : levels) {
+          double s[3] = {low, medium, high};
+          double e = exact.centroid(out, s);
+          maxDense = std::max(maxDense, std::fabs(e - dense.centroid(out, s)));
+          maxCoarse = std::max(maxCoarse, std::fabs(e - coarse.centroid(out, s)));
+          ++cases;
+        }
+      }
+    }
+  }
+
+  std::cout << "Cases:                   " << cases << "\n";
+  std::cout << "Max |exact - 200001 pt|: " << maxDense << "\n";
+  std::cout << "Max |exact - 101 pt|:    " << maxCoarse << "\n";
+
+  bool ok = maxDense < 1e-4 && maxCoarse < 2e-2;
+  std::cout << (ok ? "PASS" : "FAIL") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include "../src/dataset/Dataset.hpp"
+#include "../src/fuzzy/AdsbFuzzySystem.hpp"
+#include "../src/ga/Distributed.hpp"
+#include "../src/ga/Fitness.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ga;
+
+static pid_t forkWorker(const std::string& address) {
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    try {
+      runWorker(address, 1);
+    } catch (const std::exception& e) {
+      std::cerr << "worker: " << e.what() << "\n";
+    }
+    std::_Exit(0);
+  }
+  return pid;
+}
+
+// A worker that takes one task and dies without answering or, with
+// `hangLoading`, never finishes loading the job while staying connected.
+// Speaks the wire format directly: HELLO = 1, READY = 3 echoing the JOB's
+// count (its generation); each frame is {u32 type, u32 count, u64 bytes} and
+// a payload.
+static pid_t forkBrokenWorker(const std::string& path, bool hangLoading) {
+  pid_t pid = ::fork();
+  if (pid != 0)
+    return pid;
+
+  int         fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    std::_Exit(1);
+
+  struct {
+    uint32_t type, count;
+    uint64_t bytes;
+    uint32_t version, threads;
+  } hello = {1, 0, 8, 2, 1};
+  ::send(fd, &hello, sizeof(hello), 0);
+
+  // Skip the job, report ready, wait for a task, then vanish.
+  auto skipFrame = [&] {
+    uint32_t header[4];
+    if (::recv(fd, header, sizeof(header), MSG_WAITALL) != sizeof(header))
+      std::_Exit(1);
+    uint64_t          bytes = header[2] | (uint64_t(header[3]) << 32);
+    std::vector<char> payload(bytes);
+    ::recv(fd, payload.data(), bytes, MSG_WAITALL);
+    return header[1];
+  };
+  uint32_t generation = skipFrame();
+  if (hangLoading) {
+    ::pause();
+    std::_Exit(0);
+  }
+  uint32_t ready[4] = {3, generation, 0, 0};
+  ::send(fd, ready, sizeof(ready), 0);
+  skipFrame();
+  std::_Exit(0);
+}
+
+// Remote scores match local ones bit for bit, and keep doing so when a worker
+// is killed between batches, when one dies holding a task, and when a new
+// worker joins late. Workers are forked before anything starts a thread.
+int main() {
+  const std::string file = "/tmp/distributed_test_" + std::to_string(::getpid()) + ".adsbcol";
+  const std::string socket = "/tmp/distributed_test_" + std::to_string(::getpid()) + ".sock";
+  const std::string address = "unix:" + socket;
+
+  // Random samples for the real fuzzy inputs, in a columnar file as the
+  // preprocessing cache would write it.
+  std::mt19937                     rng(7);
+  const auto                       names = fuzzy::createAdsbFuzzySystem().inputNames();
+  const size_t                     rows = 2000;
+  std::vector<std::vector<double>> columns(names.size(), std::vector<double>(rows));
+  std::vector<double>              labels(rows);
+  std::vector<const double*>       columnPtrs;
+  for (auto& column : columns) {
+    for (double& x : column)
+      x = std::uniform_real_distribution<double>(-20.0, 50.0)(rng);
+    columnPtrs.push_back(column.data());
+  }
+  for (double& y : labels)
+    y = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+  dataset::ColumnarFile::write(file, names, columnPtrs, labels.data(), rows, 42);
+
+  Coordinator coordinator(address);
+  coordinator.setTimeout(20.0);
+  std::vector<pid_t> workers = {forkWorker(address), forkWorker(address)};
+
+  auto data = dataset::Dataset::fromMapped(std::make_shared<dataset::MappedColumnarFile>(file));
+  dataset::DatasetView view(data, 100, rows);
+  Fitness              local(view);
+  Fitness              remote(view);
+  remote.setCoordinator(&coordinator);
+
+  Rng                     geneRng(7);
+  std::vector<Chromosome> population(60);
+  for (auto& c : population)
+    c.mutate(geneRng, 0.9);
+  std::vector<const Chromosome*> batch;
+  for (const auto& c : population)
+    batch.push_back(&c);
+
+  std::vector<double> expected, actual;
+  local.evaluateBatch(batch, expected);
+
+  bool ok = true;
+  auto check = [&](const char* what) {
+    remote.evaluateBatch(batch, actual);
+    bool same = actual.size() == expected.size() &&
+                std::memcmp(actual.data(), expected.data(), expected.size() * sizeof(double)) == 0;
+    std::cout << what << ": " << (same ? "match" : "MISMATCH") << "\n";
+    ok = ok && same;
+  };
+
+  check("two workers");
+
+  ::kill(workers[0], SIGKILL);
+  ::waitpid(workers[0], nullptr, 0);
+  check("after a worker was killed");
+
+  pid_t dying = forkBrokenWorker(socket, false);
+  check("after a worker died holding a task");
+  ::waitpid(dying, nullptr, 0);
+
+  workers.push_back(forkWorker(address));
+  while (coordinator.workers() < 2)
+    check("waiting for the late worker");
+  check("after a worker joined");
+
+  remote.setInferenceMode(fuzzy::InferenceMode::SUGENO);
+  local.setInferenceMode(fuzzy::InferenceMode::SUGENO);
+  local.evaluateBatch(batch, expected);
+  check("after switching the job to Sugeno");
+
+  // Workers still loading the first of two quick job changes are sent the
+  // second too and answer READY for both; the stale READY must not drop them.
+  remote.setInferenceMode(fuzzy::InferenceMode::MAMDANI);
+  remote.setInferenceMode(fuzzy::InferenceMode::SUGENO);
+  check("after two job changes in a row");
+
+  DistributedStats stats = coordinator.stats();
+  std::cout << "joined " << stats.workersJoined << ", lost " << stats.workersLost << ", tasks "
+            << stats.tasks << ", reassigned " << stats.reassigned << "\n";
+  ok = ok && stats.workersJoined == 4 && stats.workersLost == 2 && stats.reassigned >= 1;
+
+  for (pid_t pid : workers) {
+    ::kill(pid, SIGTERM);
+    ::waitpid(pid, nullptr, 0);
+  }
+
+  // With only a worker stuck loading the job, evaluation must give up rather
+  // than wait on it forever.
+  coordinator.setTimeout(1.0);
+  pid_t stuck = forkBrokenWorker(socket, true);
+  bool  gaveUp = false;
+  try {
+    remote.evaluateBatch(batch, actual);
+  } catch (const std::exception&) {
+    gaveUp = true;
+  }
+  std::cout << "worker stuck loading: " << (gaveUp ? "gave up" : "NO ERROR") << "\n";
+  ok = ok && gaveUp;
+  ::kill(stuck, SIGKILL);
+  ::waitpid(stuck, nullptr, 0);
+  std::remove(file.c_str());
+
+  std::cout << (ok ? "PASS" : "FAIL") << "\n";
+  return ok ? 0 : 1;
+}
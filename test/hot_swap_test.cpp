@@ -0,0 +1,123 @@
+#include "../src/fuzzy/AdsbFuzzySystem.hpp"
+#include "../src/fuzzy/HotSwapModel.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace fuzzy;
+
+// Writes `params` the way the optimizer's saveOptimizedParameters() does.
+static void writeParameterFile(const std::string& path, const std::vector<double>& params) {
+  std::ofstream out(path);
+  out << "# Optimized Fuzzy System Parameters\n";
+  out << "# Validation - MSE: 0.01, F1: 0.9\n\n";
+  for (size_t i = 0; i < params.size(); ++i) {
+    out << params[i];
+    if (i < params.size() - 1)
+      out << ",";
+    if ((i + 1) % 13 == 0 && i < 51)
+      out << "\n";
+    else if ((i + 1) == 59 || (i + 1) == 66)
+      out << "\n";
+  }
+}
+
+// Reader threads score continuously while the main thread keeps publishing two
+// alternating parameter sets from files. Every result must match, bit for bit,
+// the model whose version the reader reports for that call.
+int main() {
+  FuzzyInferenceSystem base = createAdsbFuzzySystem();
+
+  std::vector<double> paramsA;
+  for (const auto& var : {createSpeedChangeVariable(), createHeadingChangeVariable(),
+                          createVerticalRateChangeVariable(), createAltitudeChangeVariable(),
+                          createTimeGapVariable(), createAnomalyLevelVariable()}) {
+    for (const auto& mf : var.mfs)
+      paramsA.insert(paramsA.end(), mf.p.begin(), mf.p.begin() + mf.paramCount());
+  }
+  std::vector<double> paramsB = paramsA;
+  paramsB[59] = 0.1; // wider Low output term
+  paramsB[64] = 0.5; // earlier High output term
+
+  const std::string fileA = "hot_swap_test_a.txt", fileB = "hot_swap_test_b.txt";
+  writeParameterFile(fileA, paramsA);
+  writeParameterFile(fileB, paramsB);
+
+  bool ok = loadParameterFile(fileB, base.parameterCount()) == paramsB;
+  try {
+    loadParameterFile(fileA, 65);
+    ok = false;
+  } catch (const std::runtime_error&) {
+  }
+
+  // Reference outputs under both parameter sets.
+  const size_t        samples = 2000;
+  const double        lo[5] = {-10.0, -180.0, -20.0, -1000.0, 0.0};
+  const double        hi[5] = {10.0, 180.0, 20.0, 1000.0, 60.0};
+  std::mt19937        rng(7);
+  std::vector<double> inputs(samples * 5), refA(samples), refB(samples);
+  for (size_t i = 0; i < samples; ++i) {
+    for (size_t v = 0; v < 5; ++v)
+      inputs[i * 5 + v] = std::uniform_real_distribution<double>(lo[v], hi[v])(rng);
+  }
+  FuzzyInferenceSystem check = base;
+  for (size_t i = 0; i < samples; ++i) {
+    check.setParameters(paramsA.data());
+    refA[i] = check.evaluate(&inputs[i * 5]);
+    check.setParameters(paramsB.data());
+    refB[i] = check.evaluate(&inputs[i * 5]);
+  }
+
+  HotSwapModel          model(base);
+  std::atomic<bool>     stop{false};
+  std::atomic<size_t>   wrong{0}, calls{0};
+  std::atomic<uint64_t> newest{0};
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      auto   reader = model.reader();
+      size_t i = 0;
+      while (!stop.load()) {
+        double out = reader.evaluate(&inputs[i * 5]);
+        // Odd versions carry parameter set A (version 1 is the initial model).
+        double expected = (reader.version() % 2) ? refA[i] : refB[i];
+        if (std::memcmp(&out, &expected, sizeof(double)) != 0)
+          ++wrong;
+        if (reader.version() > newest.load())
+          newest.store(reader.version());
+        ++calls;
+        i = (i + 1) % samples;
+      }
+    });
+  }
+
+  const uint64_t publishes = 200;
+  for (uint64_t p = 0; p < publishes; ++p) {
+    model.publishFile(p % 2 ? fileA : fileB);
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  // Give readers a moment to observe the final version.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  stop = true;
+  for (auto& r : readers)
+    r.join();
+
+  std::remove(fileA.c_str());
+  std::remove(fileB.c_str());
+
+  std::cout << "Calls:            " << calls << "\n";
+  std::cout << "Published:        " << publishes << " (final version " << model.version() << ")\n";
+  std::cout << "Newest seen:      " << newest << "\n";
+  std::cout << "Wrong results:    " << wrong << "\n";
+
+  ok = ok && wrong == 0 && model.version() == publishes + 1 && newest == model.version();
+  std::cout << (ok ? "PASS" : "FAIL") << "\n";
+  return ok ? 0 : 1;
+}
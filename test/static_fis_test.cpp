@@ -0,0 +1,69 @@
+#include "../src/fuzzy/AdsbFuzzySystem.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace fuzzy;
+
+// The compile-time ADS-B engine must reproduce the dynamic one exactly: same rule
+// table, same parameter layout, same arithmetic.
+int main() {
+  FuzzyInferenceSystem  dynamic = createAdsbFuzzySystem();
+  AdsbStaticFuzzySystem fixed;
+
+  if (AdsbStaticFuzzySystem::parameterCount() != dynamic.parameterCount()) {
+    std::cout << "FAIL: parameter count mismatch\n";
+    return 1;
+  }
+
+  // Default parameters, read back in setParameters() order.
+  std::vector<double> params;
+  for (const auto& var : {createSpeedChangeVariable(), createHeadingChangeVariable(),
+                          createVerticalRateChangeVariable(), createAltitudeChangeVariable(),
+                          createTimeGapVariable(), createAnomalyLevelVariable()}) {
+    for (const auto& mf : var.mfs)
+      params.insert(params.end(), mf.p.begin(), mf.p.begin() + mf.paramCount());
+  }
+
+  const double lo[5] = {-10.0, -180.0, -20.0, -1000.0, 0.0};
+  const double hi[5] = {10.0, 180.0, 20.0, 1000.0, 60.0};
+
+  std::mt19937                           rng(42);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::normal_distribution<double>       jitter(0.0, 0.05);
+
+  size_t mismatches = 0, cases = 0;
+  for (int set = 0; set < 20; ++set) {
+    Defuzzifier defuzzifier = (set % 2) ? Defuzzifier::sampled(101) : Defuzzifier::exact();
+    dynamic.setDefuzzifier(defuzzifier);
+    fixed.setDefuzzifier(defuzzifier);
+
+    std::vector<double> p = params;
+    if (set > 0) {
+      for (double& v : p)
+        v += jitter(rng) * (v == 0.0 ? 1.0 : v);
+    }
+    dynamic.setParameters(p.data());
+    fixed.setParameters(p.data());
+
+    for (int i = 0; i < 5000; ++i) {
+      double x[5];
+      for (int v = 0; v < 5; ++v)
+        x[v] = lo[v] + unit(rng) * (hi[v] - lo[v]);
+      // Small time gaps make the TimeGap/Small rules fire.
+      if (i % 2 == 0)
+        x[4] = unit(rng) * 6.0;
+
+      double a = dynamic.evaluate(x), b = fixed.evaluate(x);
+      if (std::memcmp(&a, &b, sizeof(double)) != 0 && mismatches++ < 5)
+        std::cout << "  mismatch: dynamic " << a << " static " << b << "\n";
+      ++cases;
+    }
+  }
+
+  std::cout << "Cases: " << cases << ", mismatches: " << mismatches << "\n";
+  std::cout << (mismatches == 0 ? "PASS" : "FAIL") << "\n";
+  return mismatches == 0 ? 0 : 1;
+}
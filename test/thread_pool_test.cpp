@@ -0,0 +1,73 @@
+#include "../src/ga/ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace ga;
+
+// Every index runs exactly once on a valid worker, a share full of slow items
+// gets stolen from, the pool is reusable across loops, and an exception from
+// one item reaches the caller.
+int main() {
+  bool ok = true;
+
+  for (size_t threads : {1, 2, 4, 7}) {
+    ThreadPool pool(threads);
+    for (size_t n : {0, 1, 5, 1000}) {
+      std::vector<std::atomic<int>> runs(n);
+      std::atomic<bool>             badWorker{false};
+      pool.parallelFor(n, [&](size_t i, size_t worker) {
+        ++runs[i];
+        if (worker >= pool.size())
+          badWorker = true;
+      });
+      for (size_t i = 0; i < n; ++i)
+        ok = ok && runs[i] == 1;
+      ok = ok && !badWorker;
+    }
+  }
+
+  // The first worker's share holds all the slow items; with stealing, other
+  // workers must end up running some of them.
+  {
+    ThreadPool          pool(4);
+    const size_t        n = 64;
+    std::vector<size_t> ranOn(n);
+    pool.parallelFor(n, [&](size_t i, size_t worker) {
+      if (i < n / 4)
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      ranOn[i] = worker;
+    });
+    size_t stolen = 0;
+    for (size_t i = 0; i < n / 4; ++i)
+      stolen += ranOn[i] != 0;
+    std::cout << "Slow items stolen: " << stolen << " of " << n / 4 << "\n";
+    ok = ok && stolen > 0;
+  }
+
+  {
+    ThreadPool       pool(3);
+    std::atomic<int> done{0};
+    bool             caught = false;
+    try {
+      pool.parallelFor(100, [&](size_t i, size_t) {
+        if (i == 42)
+          throw std::runtime_error("item 42");
+        ++done;
+      });
+    } catch (const std::runtime_error&) {
+      caught = true;
+    }
+    ok = ok && caught && done == 99;
+
+    done = 0;
+    pool.parallelFor(10, [&](size_t, size_t) { ++done; });
+    ok = ok && done == 10;
+  }
+
+  std::cout << (ok ? "PASS" : "FAIL") << "\n";
+  return ok ? 0 : 1;
+}